@@ -3,6 +3,7 @@
 #include "../../lovela/lovela-dependencies.h"
 #include "../../lovela/Lexer.h"
 #include "../../lovela/Parser.h"
+#include "../../lovela/Analyzer.h"
 #include "../../lovela/CoderCpp.h"
 
 int main_utf8(int argc, char** argv)
@@ -10,10 +11,196 @@ int main_utf8(int argc, char** argv)
 	// Intercept Ctrl-C to exit gracefully.
 	signal(SIGINT, [](int) {});
 
+	// --cache <directory>: reuse the parsed and generated code of unchanged declarations from earlier runs.
+	// --output <directory>: write the program, imports and exports files instead of printing the program.
+	// --named-locals: assign the value of each operation to a local, for debugging the generated code.
+	// --split <count>: split the program into source files that build in parallel, with --output.
+	// --unity <count>: build the split source files in batches of the count, with --split.
+	// --runtime <header|pch|module>: how the program files get the runtime, see CoderCpp::Runtime.
+	// --source-name <name>: map the generated code to the lines of the source file with this name with #line directives.
+	// --perf-map <symbols> <map>: write a perf map of the built program from its symbols, instead of generating code.
+	// --load-address <hex>: the load address of the built program for --perf-map, if it's position independent.
+	// --profile: count the calls and measure the time of each function in the built program.
+	// --profile-use <profile>: optimize the program for the function calls of the report of a --profile build, see Profile.
+	// --deduplicate: define functions with the same code as an earlier function as calls of it.
+	// --results: return the errors of the functions that may fail as lovela::result, which requires C++23.
+	std::shared_ptr<CompilationCache> cache;
+	std::optional<std::filesystem::path> outputDirectory;
+	bool namedLocals = false;
+	size_t splitCount = 0;
+	size_t unitySize = 1;
+	CoderCpp::Runtime runtime = CoderCpp::Runtime::Header;
+	std::string sourceName;
+	std::optional<std::pair<std::filesystem::path, std::filesystem::path>> perfMap;
+	uint64_t loadAddress = 0;
+	bool profile = false;
+	std::shared_ptr<Profile> profileUse;
+	bool deduplicate = false;
+	bool results = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view arg = argv[i];
+
+		if (arg == "--cache" && i + 1 < argc)
+		{
+			cache = std::make_shared<CompilationCache>(argv[++i]);
+		}
+		else if (arg == "--output" && i + 1 < argc)
+		{
+			outputDirectory = argv[++i];
+		}
+		else if (arg == "--named-locals")
+		{
+			namedLocals = true;
+		}
+		else if (arg == "--split" && i + 1 < argc)
+		{
+			splitCount = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (arg == "--unity" && i + 1 < argc)
+		{
+			unitySize = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (arg == "--runtime" && i + 1 < argc && std::string_view(argv[i + 1]) == "header")
+		{
+			runtime = CoderCpp::Runtime::Header;
+			++i;
+		}
+		else if (arg == "--runtime" && i + 1 < argc && std::string_view(argv[i + 1]) == "pch")
+		{
+			runtime = CoderCpp::Runtime::PrecompiledHeader;
+			++i;
+		}
+		else if (arg == "--runtime" && i + 1 < argc && std::string_view(argv[i + 1]) == "module")
+		{
+			runtime = CoderCpp::Runtime::Module;
+			++i;
+		}
+		else if (arg == "--source-name" && i + 1 < argc)
+		{
+			sourceName = argv[++i];
+		}
+		else if (arg == "--perf-map" && i + 2 < argc)
+		{
+			perfMap = { argv[i + 1], argv[i + 2] };
+			i += 2;
+		}
+		else if (arg == "--load-address" && i + 1 < argc)
+		{
+			loadAddress = std::strtoull(argv[++i], nullptr, 16);
+		}
+		else if (arg == "--profile")
+		{
+			profile = true;
+		}
+		else if (arg == "--profile-use" && i + 1 < argc)
+		{
+			std::ifstream file(argv[++i]);
+			if (!file)
+			{
+				std::cerr << "Failed to open the profile file.\n";
+				return 1;
+			}
+
+			profileUse = std::make_shared<Profile>();
+			profileUse->Read(file);
+		}
+		else if (arg == "--deduplicate")
+		{
+			deduplicate = true;
+		}
+		else if (arg == "--results")
+		{
+			results = true;
+		}
+		else
+		{
+			std::cerr << "Usage: lovela-stream [--cache <directory>] [--output <directory>] [--named-locals] [--split <count>] [--unity <count>]"
+				" [--runtime <header|pch|module>] [--source-name <name>] [--perf-map <symbols> <map>] [--load-address <hex>] [--profile] [--profile-use <profile>] [--deduplicate] [--results]\n";
+			return 1;
+		}
+	}
+
 	StreamLexer lexer;
 	RangeParser parser;
-	RangeCoderCpp coder;
-	std::cin >> lexer >> parser >> coder >> std::cout;
+	parser.options.cache = cache;
+	std::vector<Node> nodes;
+	std::cin >> lexer >> parser >> nodes;
+
+	// The analyzer and the coder share the threads.
+	const auto threadPool = make<ThreadPool>::shared();
+
+	// The analyzer needs all declarations to resolve the function calls.
+	Analyzer analyzer;
+	analyzer.options.threadPool = threadPool;
+	analyzer.options.inlineSize = 16;
+	analyzer.options.removeUnreachable = true;
+	analyzer.options.profileUse = profileUse;
+	analyzer.Analyze(nodes);
+
+	for (auto& error : analyzer.GetErrors())
+		std::cerr << error << '\n';
+
+	for (auto& function : analyzer.GetRemovedFunctions())
+		std::cerr << "Removed unreachable function '" << function << "'.\n";
+
+	if (perfMap.has_value())
+	{
+		std::ifstream symbols(perfMap->first);
+		std::ofstream map(perfMap->second);
+
+		if (!symbols || !map)
+		{
+			std::cerr << "Failed to open the symbols or perf map file.\n";
+			return 1;
+		}
+
+		CoderCpp::GeneratePerfMap(symbols, map, nodes, loadAddress);
+		return 0;
+	}
+
+	VectorCoderCpp coder;
+	coder.options.cache = cache;
+	coder.options.threadPool = threadPool;
+	coder.options.namedLocals = namedLocals;
+	coder.options.runtime = runtime;
+	coder.options.sourceFile = sourceName;
+	coder.options.profile = profile;
+	coder.options.profileUse = profileUse;
+	coder.options.deduplicate = deduplicate;
+	coder.options.results = results;
+
+	if (!outputDirectory.has_value())
+	{
+		nodes >> coder >> std::cout;
+		return analyzer.GetErrors().empty() ? 0 : 1;
+	}
+
+	// The program is read back from the stream when the files are generated.
+	std::stringstream program;
+	nodes >> coder >> program;
+
+	for (auto& error : coder.GetErrors())
+		std::cerr << error << '\n';
+
+	// Only write changed files, to not trigger needless rebuilds of the generated program.
+	const auto& directory = outputDirectory.value();
+	std::filesystem::create_directories(directory);
+
+	// The source files to build are printed, for the build of the split program.
+	if (splitCount)
+	{
+		for (auto& source : coder.GenerateProgramFiles(directory, splitCount, unitySize))
+			std::cout << source.string() << '\n';
+	}
+	else
+	{
+		coder.GenerateProgramFile(directory / "lovela-program.cpp");
+	}
+
+	coder.GenerateImportsFile(directory / "lovela-imports.h");
+	coder.GenerateExportsFile(directory / "lovela-exports.h");
 
-	return 0;
+	return analyzer.GetErrors().empty() && coder.GetErrors().empty() ? 0 : 1;
 }
@@ -7,6 +7,12 @@ protected:
 	[[nodiscard]] virtual ItemT& GetNext() noexcept = 0;
 	[[nodiscard]] virtual bool IsDone() noexcept = 0;
 	virtual void Advance() noexcept = 0;
+
+	// Whether the items stay valid after advancing, until the enumeration is done.
+	[[nodiscard]] virtual bool IsStable() const noexcept
+	{
+		return false;
+	}
 };
 
 /// <summary>
@@ -41,6 +47,12 @@ class RangeEnumerator : public BaseT
 		_iterator++;
 	}
 
+	[[nodiscard]] bool IsStable() const noexcept override
+	{
+		// Forward iterators refer to items that outlive them, unlike the iterators of generators.
+		return std::ranges::forward_range<RangeT>;
+	}
+
 public:
 	RangeEnumerator() noexcept = default;
 
@@ -90,6 +102,12 @@ class RangeRefEnumerator : public BaseT
 		_iterator++;
 	}
 
+	[[nodiscard]] bool IsStable() const noexcept override
+	{
+		// Forward iterators refer to items that outlive them, unlike the iterators of generators.
+		return std::ranges::forward_range<RangeT>;
+	}
+
 public:
 	RangeRefEnumerator() noexcept = default;
 
@@ -227,10 +245,12 @@ constexpr auto to_vector(std::vector<T>&& v)
 	return v;
 }
 
+// The visitor is a template parameter, so that it can be inlined, and is passed on by reference, so that it isn't copied per node.
 template <typename NodeT>
 struct Traverse
 {
-	static constexpr void DepthFirstPreorder(NodeT& tree, std::function<void(NodeT& node)> visitor) noexcept
+	template <std::invocable<NodeT&> Visitor>
+	static constexpr void DepthFirstPreorder(NodeT& tree, Visitor&& visitor) noexcept
 	{
 		visitor(tree);
 
@@ -238,7 +258,8 @@ struct Traverse
 			DepthFirstPreorder(child, visitor);
 	}
 
-	static constexpr void DepthFirstPostorder(NodeT& tree, std::function<void(NodeT& node)> visitor) noexcept
+	template <std::invocable<NodeT&> Visitor>
+	static constexpr void DepthFirstPostorder(NodeT& tree, Visitor&& visitor) noexcept
 	{
 		for (auto& child : tree.children)
 			DepthFirstPostorder(child, visitor);
@@ -246,14 +267,16 @@ struct Traverse
 		visitor(tree);
 	}
 
-	static constexpr void DepthFirstPreorder(std::ranges::range auto& range, std::function<void(NodeT& node)> visitor) noexcept
+	template <std::invocable<NodeT&> Visitor>
+	static constexpr void DepthFirstPreorder(std::ranges::range auto& range, Visitor&& visitor) noexcept
 	{
 		auto end = range.end();
 		for (auto it = range.begin(); it != end; it++)
 			DepthFirstPreorder(**it, visitor);
 	}
 
-	static constexpr void DepthFirstPostorder(std::ranges::range auto& range, std::function<void(NodeT& node)> visitor) noexcept
+	template <std::invocable<NodeT&> Visitor>
+	static constexpr void DepthFirstPostorder(std::ranges::range auto& range, Visitor&& visitor) noexcept
 	{
 		auto end = range.end();
 		for (auto it = range.begin(); it != end; it++)
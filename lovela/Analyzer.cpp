@@ -0,0 +1,736 @@
+#include "pch.h"
+#include "Analyzer.h"
+#include "TypeTable.h"
+#include "ConstantFolder.h"
+#include "Inliner.h"
+
+void Analyzer::Analyze(std::vector<Node>& nodes)
+{
+	// All declarations are known before any body is checked, so that functions can be called before they're declared.
+	for (auto& node : nodes)
+	{
+		if (node.type == Node::Type::FunctionDeclaration)
+			AddFunction(node);
+	}
+
+	std::vector<Node*> definitions;
+	for (auto& node : nodes)
+	{
+		if (node.type == Node::Type::FunctionDeclaration && !node.children.empty())
+			definitions.push_back(&node);
+	}
+
+	if (options.inlineSize)
+	{
+		Inliner::SizeLimit sizeLimit;
+		if (options.profileUse)
+		{
+			sizeLimit = [this](const Node& definition)
+			{
+				return options.profileUse->GetHeat(definition) == Profile::Heat::Hot ? options.inlineSize * 4 : options.inlineSize;
+			};
+		}
+
+		Inliner inliner(options.inlineSize, [this](const Node& call) { return Resolve(call); }, sizeLimit);
+		inliner.Inline(definitions);
+	}
+
+	// Each task only modifies the syntax tree of its own function and collects its own results,
+	// which are merged in declaration order to keep the output deterministic.
+	std::vector<Result> results(definitions.size());
+
+	// The options aren't changed, so a pool that isn't set is only used for this analysis.
+	const auto threadPool = options.threadPool ? options.threadPool : make<ThreadPool>::shared();
+
+	CallGraph graph;
+	for (size_t i = 0; i < definitions.size(); ++i)
+		graph.indices.emplace(definitions[i]->callee.get(), i);
+
+	// Inferred types may in turn make the types at other calls concrete, so the functions whose types were inferred,
+	// and the functions that call them, are analyzed again until no more types are inferred.
+	// Each round replaces at least one unknown type, and never the other way around, so the rounds end.
+	std::vector<size_t> pending(definitions.size());
+	std::iota(pending.begin(), pending.end(), size_t{});
+
+	while (!pending.empty())
+	{
+		for (auto index : pending)
+		{
+			for (auto& call : results[index].calls)
+				graph.callers[call.callee].erase(index);
+		}
+
+		threadPool->ForEach(pending.size(), [&](size_t i)
+			{
+				const auto index = pending[i];
+				results[index] = {};
+				AnalyzeFunction(*definitions[index], results[index]);
+			});
+
+		for (auto index : pending)
+		{
+			for (auto& call : results[index].calls)
+				graph.callers[call.callee].insert(index);
+		}
+
+		pending = options.inferTypes ? InferTypes(definitions, results, pending, graph) : std::vector<size_t>{};
+	}
+
+	for (auto& result : results)
+		std::ranges::move(result.errors, std::back_inserter(errors));
+
+	if (options.removeUnreachable)
+		RemoveUnreachable(nodes);
+
+	AnalyzeEffects();
+	AnalyzeConstants();
+}
+
+void Analyzer::AnalyzeEffects()
+{
+	// The main function has a fixed signature with the context, imported functions are defined outside of the program,
+	// and functions that are only declared are defined in C++, with unknown effects.
+	std::vector<std::pair<FunctionDeclaration*, const std::vector<Node*>*>> definitions;
+
+	for (auto& [function, declarations] : declarationNodes)
+	{
+		auto& effects = declarations.front()->callee->effects;
+		const bool defined = std::ranges::any_of(declarations, [](const Node* node) { return !node->children.empty(); });
+		declarations.front()->callee->defined = defined && !function->apiSpec.Is(ApiSpec::Import);
+
+		if (function->apiSpec.Is(ApiSpec::Import))
+		{
+			effects.flags = Effects::Import;
+			continue;
+		}
+
+		if (!defined)
+		{
+			effects.flags = Effects::Unknown;
+			continue;
+		}
+
+		effects.flags = function->name.empty() ? Effects::Context : Effects::None;
+		definitions.emplace_back(declarations.front()->callee.get(), &declarations);
+	}
+
+	// A function has the effects of the functions that it calls. The effects of the functions that the program doesn't define
+	// are known, and the functions that it defines are added to the callers of the called functions.
+	std::unordered_map<const FunctionDeclaration*, std::vector<FunctionDeclaration*>> callers;
+	std::vector<FunctionDeclaration*> pending;
+
+	for (auto& [function, declarations] : definitions)
+	{
+		for (auto declaration : *declarations)
+		{
+			for (auto& child : declaration->children)
+			{
+				Traverse<const Node>::DepthFirstPreorder(child, [&](const Node& node)
+					{
+						if (node.type != Node::Type::FunctionCall)
+							return;
+
+						if (node.callee && node.callee->defined)
+							callers[node.callee.get()].push_back(function);
+						else
+							function->effects.flags |= node.callee ? node.callee->effects.flags : GetStandardEffects(node);
+					});
+			}
+		}
+
+		pending.push_back(function);
+	}
+
+	// The effects only grow, so they are passed on to the callers of each function whose effects grew,
+	// until no function gets new effects, which also covers recursive calls.
+	while (!pending.empty())
+	{
+		const auto function = pending.back();
+		pending.pop_back();
+
+		if (const auto calls = callers.find(function); calls != callers.end())
+		{
+			for (auto caller : calls->second)
+			{
+				if ((caller->effects.flags | function->effects.flags) != caller->effects.flags)
+				{
+					caller->effects.flags |= function->effects.flags;
+					pending.push_back(caller);
+				}
+			}
+		}
+	}
+}
+
+void Analyzer::AnalyzeConstants()
+{
+	// Values of function templates are checked by the C++ compiler when they're instantiated.
+	const auto isLiteralType = [](const TypeSpec& type)
+	{
+		return type.Is(TypeSpec::Kind::Any) || type.Is(TypeSpec::Kind::Tagged) || (type.Is(TypeSpec::Kind::Primitive) && type.arrayDims.empty());
+	};
+
+	std::vector<std::pair<FunctionDeclaration*, const Node*>> definitions;
+
+	for (auto& [function, declarations] : declarationNodes)
+	{
+		auto& declaration = *declarations.front()->callee;
+		declaration.constant = false;
+
+		const auto definition = std::ranges::find_if(declarations, [](const Node* node) { return !node->children.empty(); });
+		if (definition == declarations.end() || !declaration.effects.IsPure() || declaration.name.empty())
+			continue;
+
+		if (!isLiteralType(declaration.inType) || !isLiteralType(declaration.outType)
+			|| !std::ranges::all_of(declaration.parameters, [&](auto& parameter) { return isLiteralType(parameter->type); }))
+			continue;
+
+		definitions.emplace_back(&declaration, *definition);
+	}
+
+	// The functions that may be constant are added to the callers of the functions that they call.
+	std::unordered_map<const FunctionDeclaration*, std::vector<std::pair<FunctionDeclaration*, const Node*>>> callers;
+
+	for (auto& definition : definitions)
+	{
+		Traverse<const Node>::DepthFirstPreorder(definition.second->children.front(), [&](const Node& node)
+			{
+				if (node.type == Node::Type::FunctionCall && node.callee)
+					callers[node.callee.get()].push_back(definition);
+			});
+	}
+
+	// A function is constant once all the functions that it calls are, so its callers are checked again when it becomes constant.
+	// Recursive functions, which can't end without branches, aren't.
+	auto pending = std::move(definitions);
+
+	while (!pending.empty())
+	{
+		const auto [function, definition] = pending.back();
+		pending.pop_back();
+
+		if (function->constant || !IsConstant(definition->children.front()))
+			continue;
+
+		function->constant = true;
+
+		if (const auto calls = callers.find(function); calls != callers.end())
+			std::ranges::copy(calls->second, std::back_inserter(pending));
+	}
+}
+
+int Analyzer::GetStandardEffects(const Node& call)
+{
+	// The standard library functions are defined by the runtime, with the context.
+	// The I/O functions use the streams, and the parameters of the program, which are system state.
+	// Checked casts raise an error, which sets the error of the context.
+	if (call.nameSpace.root && !call.nameSpace.parts.empty())
+	{
+		if (call.nameSpace.parts.front() == "io" || call.GetQualifiedName() == "/type/cast")
+			return Effects::Context;
+	}
+
+	// Other functions that the program doesn't define may do anything.
+	return Effects::Unknown;
+}
+
+bool Analyzer::IsConstant(const Node& node) noexcept
+{
+	switch (node.type)
+	{
+	case Node::Type::Literal:
+		return node.token.type == Token::Type::LiteralInteger || node.token.type == Token::Type::LiteralDecimal;
+
+	case Node::Type::FunctionCall:
+		if (!node.callee || !node.callee->constant)
+			return false;
+
+		[[fallthrough]];
+
+	case Node::Type::Expression:
+	case Node::Type::ExpressionInput:
+	case Node::Type::BinaryOperation:
+	case Node::Type::VariableReference:
+	case Node::Type::Tuple:
+	case Node::Type::Empty:
+		return std::ranges::all_of(node.children, [](const Node& child) { return IsConstant(child); });
+
+	default:
+		return false;
+	}
+}
+
+void Analyzer::RemoveUnreachable(std::vector<Node>& nodes)
+{
+	// The main function and the exported functions are called from outside of the program.
+	std::unordered_set<const FunctionDeclaration*> reachable;
+	std::vector<const FunctionDeclaration*> pending;
+
+	const auto reach = [&](const FunctionDeclaration* function)
+	{
+		if (function && reachable.insert(function).second)
+			pending.push_back(function);
+	};
+
+	for (auto& node : nodes)
+	{
+		if (node.type == Node::Type::FunctionDeclaration && (node.value.empty() || node.apiSpec.Is(ApiSpec::Export)))
+			reach(node.callee.get());
+	}
+
+	while (!pending.empty())
+	{
+		const auto function = pending.back();
+		pending.pop_back();
+
+		for (auto declaration : declarationNodes.at(function))
+		{
+			for (auto& child : declaration->children)
+			{
+				Traverse<const Node>::DepthFirstPreorder(child, [&](const Node& node)
+					{
+						if (node.type == Node::Type::FunctionCall)
+							reach(node.callee.get());
+					});
+			}
+		}
+	}
+
+	std::unordered_set<const FunctionDeclaration*> removed;
+
+	std::erase_if(nodes, [&](const Node& node)
+		{
+			if (node.type != Node::Type::FunctionDeclaration || reachable.contains(node.callee.get()))
+				return false;
+
+			if (removed.insert(node.callee.get()).second)
+				removedFunctions.push_back(node.GetQualifiedName());
+
+			return true;
+		});
+
+	// The remaining nodes have moved.
+	declarationNodes.clear();
+	for (auto& node : nodes)
+	{
+		if (node.type == Node::Type::FunctionDeclaration)
+			declarationNodes[node.callee.get()].push_back(&node);
+	}
+}
+
+std::vector<size_t> Analyzer::InferTypes(const std::vector<Node*>& definitions, const std::vector<Result>& results, const std::vector<size_t>& analyzed, const CallGraph& graph)
+{
+	// Only the out types of the analyzed functions, and the types of the calls in them, can have changed.
+	std::set<size_t> candidates(analyzed.begin(), analyzed.end());
+	for (auto index : analyzed)
+	{
+		for (auto& call : results[index].calls)
+		{
+			if (const auto callee = graph.indices.find(call.callee); callee != graph.indices.end())
+				candidates.insert(callee->second);
+		}
+	}
+
+	std::set<size_t> pending;
+
+	for (auto i : candidates)
+	{
+		auto& node = *definitions[i];
+		auto& declaration = *node.callee;
+
+		// The signatures of exported and imported functions are fixed, and overloads could become ambiguous.
+		if (node.value.empty() || node.apiSpec.Is(ApiSpec::Export) || node.apiSpec.Is(ApiSpec::Import) || functions.at(node.GetQualifiedName()).size() > 1)
+			continue;
+
+		auto& nodes = declarationNodes.at(&declaration);
+
+		std::vector<const Call*> functionCalls;
+		if (const auto callers = graph.callers.find(&declaration); callers != graph.callers.end())
+		{
+			for (auto caller : callers->second)
+			{
+				for (auto& call : results[caller].calls)
+				{
+					if (call.callee == &declaration)
+						functionCalls.push_back(&call);
+				}
+			}
+		}
+
+		bool inferred = false;
+
+		if (declaration.inType.Is(TypeSpec::Kind::Any) && !functionCalls.empty())
+		{
+			std::vector<const TypeSpec*> types;
+			for (auto& call : functionCalls)
+				types.push_back(&call->inType);
+
+			if (const auto type = GetCommonType(types))
+			{
+				declaration.inType = type.value();
+				for (auto& n : nodes)
+					n->inType = type.value();
+				inferred = true;
+			}
+		}
+
+		for (size_t p = 0; p < declaration.parameters.size() && !functionCalls.empty(); ++p)
+		{
+			if (!declaration.parameters[p]->type.Is(TypeSpec::Kind::Any))
+				continue;
+
+			std::vector<const TypeSpec*> types;
+			for (auto& call : functionCalls)
+				types.push_back(&call->parameterTypes[p]);
+
+			if (const auto type = GetCommonType(types))
+			{
+				declaration.parameters[p]->type = type.value();
+				for (auto& n : nodes)
+					n->parameters[p]->type = type.value();
+				inferred = true;
+			}
+		}
+
+		if (declaration.outType.Is(TypeSpec::Kind::Any) && IsConcrete(results[i].outType))
+		{
+			declaration.outType = results[i].outType;
+			for (auto& n : nodes)
+				n->outType = results[i].outType;
+			inferred = true;
+		}
+
+		// The function and its callers are analyzed again with the inferred types.
+		if (inferred)
+		{
+			pending.insert(i);
+			if (const auto callers = graph.callers.find(&declaration); callers != graph.callers.end())
+				pending.insert(callers->second.begin(), callers->second.end());
+		}
+	}
+
+	return { pending.begin(), pending.end() };
+}
+
+const FunctionDeclaration* Analyzer::Resolve(const Node& call) const
+{
+	// Resolves calls before their types are known, so only functions without overloads.
+	const auto iter = functions.find(call.GetQualifiedName());
+	return iter != functions.end() && iter->second.size() == 1 ? iter->second.front().get() : nullptr;
+}
+
+bool Analyzer::IsConcrete(const TypeSpec& type) noexcept
+{
+	// Only scalar primitive types have a C++ type that values of the type can always be converted to.
+	return type.Is(TypeSpec::Kind::Primitive) && type.arrayDims.empty();
+}
+
+bool Analyzer::IsSameConcrete(const TypeSpec& type1, const TypeSpec& type2) noexcept
+{
+	// The primitive types of the literals have no namespace, and declared primitive types have the type namespace.
+	return IsConcrete(type1) && IsConcrete(type2) && type1.primitive == type2.primitive;
+}
+
+TypeSpec Analyzer::GetInferredType(const Node& node, const TypeSpec& type)
+{
+	if (node.type != Node::Type::Literal || !type.Is(TypeSpec::Kind::Primitive) || !type.arrayDims.empty())
+		return type;
+
+	// The coder emits literals as C++ literals, so infer the type that C++ gives them, to not change the values.
+	if (type.primitive.floatType)
+		return TypeTable::Intern({ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 64, .floatType = true} });
+	else if (type.primitive.bits < 32 || (type.primitive.bits == 32 && type.primitive.signedType))
+		return TypeTable::Intern({ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .signedType = true} });
+	else
+		return TypeTable::Intern({ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 64, .signedType = type.primitive.signedType} });
+}
+
+std::optional<TypeSpec> Analyzer::GetCommonType(const std::vector<const TypeSpec*>& types)
+{
+	// Returns the type if all the types are the same. A wider type that the others are compatible with would convert
+	// the values of the other calls, which can lose precision, and make integer arithmetic floating point.
+	std::optional<TypeSpec> common;
+
+	for (auto type : types)
+	{
+		if (!IsConcrete(*type) || (common.has_value() && !IsSameConcrete(common.value(), *type)))
+			return {};
+
+		common = *type;
+	}
+
+	return common;
+}
+
+bool Analyzer::IsCompatible(const TypeSpec& actual, const TypeSpec& expected) noexcept
+{
+	static constexpr auto isUnknown = [](const TypeSpec& type)
+	{
+		return type.Is(TypeSpec::Kind::Any) || type.Is(TypeSpec::Kind::Tagged) || type.Is(TypeSpec::Kind::Invalid);
+	};
+
+	if (isUnknown(actual) || isUnknown(expected))
+		return true;
+
+	if (actual.kind != expected.kind)
+		return false;
+
+	if (actual.arrayDims.size() != expected.arrayDims.size())
+		return false;
+
+	for (size_t i = 0; i < actual.arrayDims.size(); ++i)
+	{
+		// Zero means an array of any length.
+		if (expected.arrayDims[i] && actual.arrayDims[i] != expected.arrayDims[i])
+			return false;
+	}
+
+	switch (expected.kind)
+	{
+	case TypeSpec::Kind::Named:
+		return actual.name == expected.name && actual.nameSpace == expected.nameSpace;
+
+	case TypeSpec::Kind::Primitive:
+	{
+		// Only allow conversions that don't lose information, except from integers to floating point values.
+		const auto& a = actual.primitive;
+		const auto& e = expected.primitive;
+
+		if (e.floatType)
+			return !a.floatType || a.bits <= e.bits;
+		else if (a.floatType)
+			return false;
+		else if (a.signedType == e.signedType)
+			return a.bits <= e.bits;
+		else
+			return !a.signedType && a.bits < e.bits;
+	}
+
+	default:
+		return true;
+	}
+}
+
+bool Analyzer::IsCompatible(const Node& node, const TypeSpec& actual, const TypeSpec& expected) noexcept
+{
+	if (IsCompatible(actual, expected))
+		return true;
+
+	// A non-negative integer literal that fits in a signed type also fits in the unsigned type of the same size.
+	if (node.type == Node::Type::Literal && actual.Is(TypeSpec::Kind::Primitive) && actual.primitive.signedType && !actual.primitive.floatType
+		&& !node.value.starts_with('-'))
+	{
+		auto unsignedType = actual;
+		unsignedType.SetPrimitive({ .bits = actual.primitive.bits, .signedType = false, .floatType = false });
+		return IsCompatible(unsignedType, expected);
+	}
+
+	return false;
+}
+
+bool Analyzer::IsCompatible(const FunctionDeclaration& function, const Node& input, const TypeSpec& inType, const std::vector<std::pair<const Node*, TypeSpec>>& arguments) noexcept
+{
+	if (!IsCompatible(input, inType, function.inType))
+		return false;
+
+	if (arguments.size() != function.parameters.size())
+		return false;
+
+	for (size_t i = 0; i < arguments.size(); ++i)
+	{
+		if (!IsCompatible(*arguments[i].first, arguments[i].second, function.parameters[i]->type))
+			return false;
+	}
+
+	return true;
+}
+
+bool Analyzer::HasSameSignature(const FunctionDeclaration& function1, const FunctionDeclaration& function2) noexcept
+{
+	return function1.inType == function2.inType
+		&& function1.outType == function2.outType
+		&& std::ranges::equal(function1.parameters, function2.parameters, [](auto& p1, auto& p2) { return p1->type == p2->type; });
+}
+
+void Analyzer::AddFunction(Node& node)
+{
+	auto declaration = make<FunctionDeclaration>::shared(node.ToFunctionDeclaration());
+	auto& overloads = functions[node.GetQualifiedName()];
+
+	// A forward declaration and the definition of a function share the declaration object.
+	auto iter = std::ranges::find_if(overloads, [&](auto& overload) { return HasSameSignature(*overload, *declaration); });
+	if (iter != overloads.end())
+		node.callee = *iter;
+	else
+		node.callee = overloads.emplace_back(std::move(declaration));
+
+	declarationNodes[node.callee.get()].push_back(&node);
+}
+
+void Analyzer::AnalyzeFunction(Node& node, Result& result) const
+{
+	Context context{ .function = node, .result = result };
+
+	auto& body = node.children.front();
+
+	if (options.foldConstants)
+	{
+		const ConstantFolder folder([this](const Node& call) { return Resolve(call); });
+
+		folder.Fold(body);
+	}
+
+	const auto outType = AnalyzeNode(body, node.inType, context);
+	result.outType = GetInferredType(body, outType);
+
+	if (!node.outType.Is(TypeSpec::Kind::None) && !IsCompatible(body, outType, node.outType))
+	{
+		AddError(context, node, fmt::format("The output type {} of function '{}' isn't compatible with its declared output type {}.",
+			outType.GetQualifiedName(), node.GetQualifiedName(), node.outType.GetQualifiedName()));
+	}
+}
+
+TypeSpec Analyzer::AnalyzeNode(Node& node, const TypeSpec& inType, Context& context) const
+{
+	switch (node.type)
+	{
+	case Node::Type::Expression:
+	{
+		// Each operation takes the output of the previous one as input.
+		auto type = inType;
+		for (auto& operation : node.children)
+			type = AnalyzeNode(operation, type, context);
+		return type;
+	}
+
+	case Node::Type::ExpressionInput:
+		return inType;
+
+	case Node::Type::FunctionCall:
+		return AnalyzeFunctionCall(node, inType, context);
+
+	case Node::Type::BinaryOperation:
+		return AnalyzeBinaryOperation(node, inType, context);
+
+	case Node::Type::Literal:
+		return node.outType;
+
+	case Node::Type::VariableReference:
+		return AnalyzeVariableReference(node, context);
+
+	case Node::Type::Tuple:
+	case Node::Type::ExpressionList:
+		for (auto& child : node.children)
+			static_cast<void>(AnalyzeNode(child, inType, context));
+		return {};
+
+	default:
+		return {};
+	}
+}
+
+TypeSpec Analyzer::AnalyzeFunctionCall(Node& node, const TypeSpec& inType, Context& context) const
+{
+	auto& input = node.children.front();
+	const auto callInType = AnalyzeNode(input, inType, context);
+
+	std::vector<std::pair<const Node*, TypeSpec>> arguments;
+	if (node.children.size() > 1)
+	{
+		auto& group = node.children[1];
+
+		if (group.type == Node::Type::Tuple)
+		{
+			for (auto& argument : group.children)
+				arguments.emplace_back(&argument, AnalyzeNode(argument, inType, context));
+		}
+		else if (group)
+		{
+			arguments.emplace_back(&group, AnalyzeNode(group, inType, context));
+		}
+	}
+
+	const auto iter = functions.find(node.GetQualifiedName());
+	if (iter == functions.end())
+	{
+		AddError(context, node, fmt::format("Function '{}' isn't declared.", node.GetQualifiedName()));
+		return {};
+	}
+
+	const auto& overloads = iter->second;
+	const auto overload = std::ranges::find_if(overloads, [&](auto& function) { return IsCompatible(*function, input, callInType, arguments); });
+
+	if (overload != overloads.end())
+	{
+		node.callee = *overload;
+
+		Call call{ .callee = node.callee.get(), .inType = GetInferredType(input, callInType) };
+		for (auto& argument : arguments)
+			call.parameterTypes.emplace_back(GetInferredType(*argument.first, argument.second));
+		context.result.calls.emplace_back(std::move(call));
+	}
+	else
+	{
+		// Link the call to the first declaration anyway, so that later passes see the call.
+		node.callee = overloads.front();
+
+		if (overloads.size() > 1)
+		{
+			AddError(context, node, fmt::format("No declaration of function '{}' is compatible with the input type {} and {} arguments.",
+				node.GetQualifiedName(), callInType.GetQualifiedName(), arguments.size()));
+		}
+		else if (arguments.size() != node.callee->parameters.size())
+		{
+			AddError(context, node, fmt::format("Function '{}' takes {} parameters, but {} arguments were given.",
+				node.GetQualifiedName(), node.callee->parameters.size(), arguments.size()));
+		}
+		else if (!IsCompatible(input, callInType, node.callee->inType))
+		{
+			AddError(context, node, fmt::format("The input type {} isn't compatible with the input type {} of function '{}'.",
+				callInType.GetQualifiedName(), node.callee->inType.GetQualifiedName(), node.GetQualifiedName()));
+		}
+		else
+		{
+			AddError(context, node, fmt::format("The arguments aren't compatible with the parameter types of function '{}'.", node.GetQualifiedName()));
+		}
+	}
+
+	// A tagged output type that equals the tagged input type is the type of the actual input.
+	const auto& callee = *node.callee;
+	if (callee.outType.Is(TypeSpec::Kind::Tagged))
+		return callee.outType == callee.inType ? callInType : TypeSpec{};
+
+	return callee.outType;
+}
+
+TypeSpec Analyzer::AnalyzeBinaryOperation(Node& node, const TypeSpec& inType, Context& context) const
+{
+	// Literals have the type that C++ gives them.
+	std::vector<TypeSpec> operands;
+	for (auto& child : node.children)
+		operands.emplace_back(GetInferredType(child, AnalyzeNode(child, inType, context)));
+
+	// Only arithmetic on operands of the same primitive type has a known result type,
+	// and only if C++ doesn't promote the operands to a larger type.
+	if (node.token.type == Token::Type::OperatorArithmetic && operands.size() == 2 && IsSameConcrete(operands[0], operands[1])
+		&& (operands[0].primitive.floatType || operands[0].primitive.bits >= 32))
+		return operands[0];
+
+	return {};
+}
+
+TypeSpec Analyzer::AnalyzeVariableReference(Node& node, Context& context) const
+{
+	for (auto& parameter : context.function.parameters)
+	{
+		if (parameter->name == node.value)
+			return parameter->type;
+	}
+
+	return {};
+}
+
+void Analyzer::AddError(Context& context, const Node& node, std::string_view message)
+{
+	context.result.errors.emplace_back(fmt::format("Error: {} Line {}, column {}.", message, node.token.error.line, node.token.error.column));
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include "Node.h"
+#include "ThreadPool.h"
+#include "Profile.h"
+
+// Checks the syntax trees between the parser and the coder:
+// resolves the callee of each function call and checks that input, output and parameter types are compatible.
+// Inlines small functions, folds constant expressions, and infers the unknown types of functions from their calls.
+// Sets Node::callee of function calls to the called declaration, and of function declarations to the declaration itself,
+// so that all references to a function share the same declaration object.
+// Sets FunctionDeclaration::effects of the declarations to the effects of calling the functions,
+// and FunctionDeclaration::constant of pure functions that only compute with numbers.
+class Analyzer
+{
+public:
+	struct Options
+	{
+		// Runs the checks of the function bodies in parallel. A default pool is created for each analysis if none is set.
+		std::shared_ptr<ThreadPool> threadPool;
+
+		// Replaces the unknown in, out and parameter types of functions with the concrete type that all calls have,
+		// so that the coder emits concrete C++ types instead of function templates.
+		bool inferTypes = true;
+
+		// Evaluates operations on literals at compile time. See ConstantFolder.
+		bool foldConstants = true;
+
+		// Inlines calls to functions with at most this number of nodes in their bodies, if not zero. See Inliner.
+		size_t inlineSize = 0;
+
+		// Inlines calls to the hot functions of the profile, with up to four times Options::inlineSize nodes, if set.
+		std::shared_ptr<const Profile> profileUse;
+
+		// Removes the declarations of functions that can't be reached from the main function or an exported function.
+		bool removeUnreachable = false;
+	} options;
+
+	void Analyze(std::vector<Node>& nodes);
+
+	[[nodiscard]] const std::vector<std::string>& GetErrors() const noexcept
+	{
+		return errors;
+	}
+
+	// The qualified names of the functions removed by Options::removeUnreachable, in declaration order.
+	[[nodiscard]] const std::vector<std::string>& GetRemovedFunctions() const noexcept
+	{
+		return removedFunctions;
+	}
+
+	// Checks whether a value of the actual type can be passed where the expected type is required.
+	// Unknown (any, tagged or invalid) types are compatible with all types.
+	[[nodiscard]] static bool IsCompatible(const TypeSpec& actual, const TypeSpec& expected) noexcept;
+
+private:
+	using FunctionTable = std::unordered_map<std::string, std::vector<std::shared_ptr<FunctionDeclaration>>>;
+
+	struct Call
+	{
+		const FunctionDeclaration* callee{};
+		TypeSpec inType;
+		std::vector<TypeSpec> parameterTypes;
+	};
+
+	struct Result
+	{
+		TypeSpec outType;
+		std::vector<Call> calls;
+		std::vector<std::string> errors;
+	};
+
+	struct Context
+	{
+		const Node& function;
+		Result& result;
+	};
+
+	// The definitions by their declarations, and the definitions that call each function, for the inference of types.
+	struct CallGraph
+	{
+		std::unordered_map<const FunctionDeclaration*, size_t> indices;
+		std::unordered_map<const FunctionDeclaration*, std::set<size_t>> callers;
+	};
+
+	void AddFunction(Node& node);
+	void AnalyzeFunction(Node& node, Result& result) const;
+	std::vector<size_t> InferTypes(const std::vector<Node*>& definitions, const std::vector<Result>& results, const std::vector<size_t>& analyzed, const CallGraph& graph);
+	void RemoveUnreachable(std::vector<Node>& nodes);
+	void AnalyzeEffects();
+	void AnalyzeConstants();
+	[[nodiscard]] const FunctionDeclaration* Resolve(const Node& call) const;
+
+	[[nodiscard]] TypeSpec AnalyzeNode(Node& node, const TypeSpec& inType, Context& context) const;
+	[[nodiscard]] TypeSpec AnalyzeFunctionCall(Node& node, const TypeSpec& inType, Context& context) const;
+	[[nodiscard]] TypeSpec AnalyzeBinaryOperation(Node& node, const TypeSpec& inType, Context& context) const;
+	[[nodiscard]] TypeSpec AnalyzeVariableReference(Node& node, Context& context) const;
+
+	[[nodiscard]] static bool IsCompatible(const Node& node, const TypeSpec& actual, const TypeSpec& expected) noexcept;
+	[[nodiscard]] static bool IsCompatible(const FunctionDeclaration& function, const Node& input, const TypeSpec& inType, const std::vector<std::pair<const Node*, TypeSpec>>& arguments) noexcept;
+	[[nodiscard]] static bool HasSameSignature(const FunctionDeclaration& function1, const FunctionDeclaration& function2) noexcept;
+	[[nodiscard]] static bool IsConcrete(const TypeSpec& type) noexcept;
+	[[nodiscard]] static bool IsSameConcrete(const TypeSpec& type1, const TypeSpec& type2) noexcept;
+	[[nodiscard]] static bool IsConstant(const Node& node) noexcept;
+	[[nodiscard]] static int GetStandardEffects(const Node& call);
+	[[nodiscard]] static TypeSpec GetInferredType(const Node& node, const TypeSpec& type);
+	[[nodiscard]] static std::optional<TypeSpec> GetCommonType(const std::vector<const TypeSpec*>& types);
+	static void AddError(Context& context, const Node& node, std::string_view message);
+
+	FunctionTable functions;
+	std::unordered_map<const FunctionDeclaration*, std::vector<Node*>> declarationNodes;
+	std::vector<std::string> errors;
+	std::vector<std::string> removedFunctions;
+};
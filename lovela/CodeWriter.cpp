@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "CodeWriter.h"
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+CodeWriter::CodeWriter(std::ostream& output) noexcept
+	: output(&output)
+{
+}
+
+CodeWriter::CodeWriter(int fileDescriptor) noexcept
+	: file(fileDescriptor)
+{
+}
+
+void CodeWriter::Flush()
+{
+	if ((!output && file < 0) || !buffer.size())
+		return;
+
+	if (output)
+	{
+		output->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	}
+	else
+	{
+		// A write may be partial, or interrupted by a signal before anything is written.
+		for (size_t written = 0; written < buffer.size();)
+		{
+			const auto remaining = buffer.size() - written;
+#ifdef _WIN32
+			const auto result = _write(file, buffer.data() + written, static_cast<unsigned int>(std::min<size_t>(remaining, std::numeric_limits<int>::max())));
+#else
+			const auto result = write(file, buffer.data() + written, remaining);
+#endif
+			if (result < 0)
+			{
+				if (errno == EINTR)
+					continue;
+
+				throw std::system_error(errno, std::generic_category(), "The generated code can't be written.");
+			}
+
+			written += static_cast<size_t>(result);
+		}
+	}
+
+	flushed += buffer.size();
+	buffer.clear();
+}
+
+CodeWriter& CodeWriter::NewLine(size_t indent)
+{
+	const auto length = 1 + indent * IndentSize;
+	if (indentation.size() < length)
+		indentation.resize(length, ' ');
+
+	buffer.append(std::string_view(indentation).substr(0, length));
+	return Written();
+}
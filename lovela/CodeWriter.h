@@ -0,0 +1,80 @@
+#pragma once
+
+// Collects generated code in a memory buffer, and writes it to the output stream or file descriptor in large blocks
+// instead of as many small formatted writes.
+// Code is kept in memory if there's no output.
+class CodeWriter
+{
+public:
+	CodeWriter() noexcept = default;
+	CodeWriter(std::ostream& output) noexcept;
+	// Writes to an open file descriptor, which the caller closes, without the buffering of a stream.
+	explicit CodeWriter(int fileDescriptor) noexcept;
+
+	void SetOutput(std::ostream* stream) noexcept
+	{
+		output = stream;
+		file = -1;
+	}
+
+	void SetOutputFile(int fileDescriptor) noexcept
+	{
+		output = {};
+		file = fileDescriptor;
+	}
+
+	// Writes the buffered code to the output. Throws std::system_error if the file can't be written.
+	void Flush();
+
+	// The code that hasn't been flushed yet.
+	[[nodiscard]] std::string_view GetBuffer() const noexcept
+	{
+		return { buffer.data(), buffer.size() };
+	}
+
+	// The size of all written code, flushed or not.
+	[[nodiscard]] size_t GetSize() const noexcept
+	{
+		return flushed + buffer.size();
+	}
+
+	CodeWriter& operator<<(char c)
+	{
+		buffer.push_back(c);
+		return Written();
+	}
+
+	CodeWriter& operator<<(std::string_view text)
+	{
+		buffer.append(text);
+		return Written();
+	}
+
+	CodeWriter& operator<<(std::integral auto value)
+	{
+		fmt::format_to(std::back_inserter(buffer), "{}", value);
+		return Written();
+	}
+
+	// Starts a new line, indented by the given number of levels.
+	CodeWriter& NewLine(size_t indent = 0);
+
+private:
+	CodeWriter& Written()
+	{
+		if ((output || file >= 0) && buffer.size() >= FlushSize)
+			Flush();
+
+		return *this;
+	}
+
+	static constexpr size_t FlushSize{ 1 << 16 };
+	static constexpr size_t IndentSize{ 2 };
+
+	fmt::memory_buffer buffer;
+	std::ostream* output{};
+	int file{ -1 };
+	size_t flushed{};
+	// A newline followed by the spaces of the deepest indentation so far.
+	std::string indentation{ "\n" };
+};
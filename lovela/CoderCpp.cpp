@@ -2,77 +2,410 @@
 #include "CoderCpp.h"
 #include "StandardCDeclarations.h"
 #include "StandardCppDeclarations.h"
+#include "NodeSerializer.h"
 
-std::map<Node::Type, CoderCpp::Visitor>& CoderCpp::GetVisitors()
+const TypeSpec& CoderCpp::GetVoidType()
+{
+	static TypeSpec t{ .name = "void" };
+	return t;
+}
+
+const TypeSpec& CoderCpp::GetVoidPtrType()
+{
+	static TypeSpec t{ .name = "void*" };
+	return t;
+}
+
+namespace
 {
-	static std::map<Node::Type, Visitor> visitors
+	// Generates the code of a part of the top-level declarations, for CoderCpp::CodeParallel.
+	class PartCoderCpp : public CoderCpp
 	{
-		{ Node::Type::Error,&CoderCpp::ErrorVisitor },
-		{ Node::Type::FunctionDeclaration, &CoderCpp::FunctionDeclarationVisitor },
+	public:
+		PartCoderCpp(std::span<Node* const> nodes, std::span<const std::string> implementations) noexcept
+			: nodes(nodes)
+			, implementations(implementations)
+		{
+		}
+
+	private:
+		[[nodiscard]] Node& GetNext() noexcept override
+		{
+			return *nodes[index];
+		}
+
+		[[nodiscard]] bool IsDone() noexcept override
+		{
+			return index == nodes.size();
+		}
+
+		void Advance() noexcept override
+		{
+			++index;
+		}
+
+		// The implementations are found for all parts before they are generated.
+		std::string FindImplementation(const Node&) override
+		{
+			return implementations[index];
+		}
+
+		std::span<Node* const> nodes;
+		std::span<const std::string> implementations;
+		size_t index{};
 	};
 
-	return visitors;
+	// Gets the name of a function, and its template arguments, from the demangled function signature.
+	// For example "f_name" and "<int>" from "auto f_name<int>(lovela::context&, int&&)".
+	std::pair<std::string_view, std::string_view> ParseFunctionName(std::string_view signature) noexcept
+	{
+		// The parameter list is the first parenthesis outside of template arguments.
+		size_t depth = 0;
+		size_t end = 0;
+
+		for (; end < signature.size(); ++end)
+		{
+			const char c = signature[end];
+
+			if (c == '<')
+				++depth;
+			else if (c == '>' && depth)
+				--depth;
+			else if (c == '(' && !depth)
+				break;
+		}
+
+		auto name = signature.substr(0, end);
+		std::string_view templateArguments;
+
+		if (name.ends_with('>'))
+		{
+			depth = 0;
+
+			for (size_t i = name.size(); i-- > 0;)
+			{
+				if (name[i] == '>')
+					++depth;
+				else if (name[i] == '<' && !--depth)
+				{
+					templateArguments = name.substr(i);
+					name = name.substr(0, i);
+					break;
+				}
+			}
+		}
+
+		// The return type precedes the name.
+		if (const auto space = name.rfind(' '); space != std::string_view::npos)
+			name = name.substr(space + 1);
+
+		return { name, templateArguments };
+	}
+}
+
+CoderCpp::CoderCpp(OutputT& output) noexcept
+	: streamPtr(&output)
+{
 }
 
-std::map<Node::Type, CoderCpp::Visitor>& CoderCpp::GetInternalVisitors()
+void CoderCpp::Code() noexcept
 {
-	static std::map<Node::Type, Visitor> visitors
+	writer.SetOutput(streamPtr);
+
+	if (options.threadPool)
 	{
-		{ Node::Type::Expression, &CoderCpp::ExpressionVisitor },
-		{ Node::Type::ExpressionInput, &CoderCpp::ExpressionInputVisitor },
-		{ Node::Type::FunctionCall, &CoderCpp::FunctionCallVisitor },
-		{ Node::Type::BinaryOperation, &CoderCpp::BinaryOperationVisitor },
-		{ Node::Type::Literal, &CoderCpp::LiteralVisitor },
-		{ Node::Type::Tuple, &CoderCpp::TupleVisitor },
-		{ Node::Type::VariableReference, &CoderCpp::VariableReferenceVisitor },
-	};
+		CodeParallel();
+	}
+	else
+	{
+		while (!IsDone())
+		{
+			CodeNode(GetNext());
+			Advance();
+		}
+	}
 
-	return visitors;
+	writer.Flush();
 }
 
-const TypeSpec& CoderCpp::GetVoidType()
+void CoderCpp::CodeNode(Node& node)
 {
-	static TypeSpec t{ .name = "void" };
-	return t;
+	implementation = options.deduplicate && !options.profile ? FindImplementation(node) : std::string();
+
+	if (options.cache)
+		CodeCached(node);
+	else
+		GenerateNode(node);
 }
 
-const TypeSpec& CoderCpp::GetVoidPtrType()
+std::string CoderCpp::FindImplementation(const Node& node)
 {
-	static TypeSpec t{ .name = "void*" };
-	return t;
+	if (node.type != Node::Type::FunctionDeclaration || node.value.empty() || node.children.empty() || node.apiSpec.Is(ApiSpec::Import))
+		return {};
+
+	// The code of functions whose trees only differ in the name and the positions of the tokens is the same,
+	// if the functions and the functions that they call have the same effects.
+	Node normalized = node;
+	normalized.value.clear();
+	normalized.token.value.clear();
+	normalized.nameSpace = {};
+	Traverse<Node>::DepthFirstPreorder(normalized, [](Node& n)
+		{
+			n.token.error.line = 0;
+			n.token.error.column = 0;
+			n.token.error.length = 0;
+		});
+
+	std::string code;
+	MsgPackWriter writer(code);
+	NodeSerializer::Serialize(writer, normalized, 0);
+
+	Traverse<const Node>::DepthFirstPreorder(node, [&](const Node& n)
+		{
+			if (n.type == Node::Type::FunctionDeclaration || n.type == Node::Type::FunctionCall)
+			{
+				writer.WriteInt(n.callee ? n.callee->effects.flags : Effects::Unknown);
+				writer.WriteBool(n.callee && n.callee->constant);
+			}
+		});
+
+	// The first function with the code is its implementation.
+	const auto [iter, inserted] = implementations.try_emplace(std::move(code), node.value);
+	return iter->second != node.value ? iter->second : std::string();
 }
 
-CoderCpp::CoderCpp(OutputT& output) noexcept
-	: streamPtr(&output)
+void CoderCpp::GenerateNode(Node& node)
 {
+	BeginDefinition();
+	Traverse<Node>::DepthFirstPostorder(node, [this](Node& n) { Visit(n); });
+	EndDefinition();
 }
 
-void CoderCpp::Code() noexcept
+void CoderCpp::BeginDefinition()
+{
+	EndDefinition();
+	definitions.emplace_back();
+	definitionStart = writer.GetSize();
+}
+
+void CoderCpp::EndDefinition()
 {
-	while (!IsDone())
+	if (!definitions.empty())
+		definitions.back().size = writer.GetSize() - definitionStart;
+}
+
+void CoderCpp::CodeParallel()
+{
+	// The top-level declarations are independent, so they are split in parts that are generated by separate coders.
+	// The code, headers, exports and errors of the parts are then merged in input order,
+	// so that the output is the same as when generated sequentially.
+
+	// Items that don't outlive the enumeration are copied.
+	std::vector<Node*> nodes;
+	std::deque<Node> copies;
+	const bool stable = IsStable();
+
+	for (; !IsDone(); Advance())
+		nodes.push_back(stable ? &GetNext() : &copies.emplace_back(GetNext()));
+
+	// The implementations of the deduplicated functions are the first functions in input order, in all parts,
+	// so they are found in one pass before the parts are generated.
+	std::vector<std::string> implementationNames(nodes.size());
+
+	if (options.deduplicate && !options.profile)
 	{
-		Traverse<Node>::DepthFirstPostorder(GetNext(), [this](Node& node) { Visit(node); });
-		Advance();
+		for (size_t i = 0; i < nodes.size(); ++i)
+			implementationNames[i] = FindImplementation(*nodes[i]);
+	}
+
+	// A few parts per thread balance the load without much overhead per part.
+	const auto partCount = std::min(nodes.size(), options.threadPool->GetThreadCount() * 4);
+	std::deque<PartCoderCpp> parts;
+
+	for (size_t i = 0; i < partCount; ++i)
+	{
+		const auto begin = nodes.size() * i / partCount;
+		const auto end = nodes.size() * (i + 1) / partCount;
+		auto& part = parts.emplace_back(std::span(nodes).subspan(begin, end - begin), std::span(implementationNames).subspan(begin, end - begin));
+		part.options = options;
+		part.options.threadPool = {};
+	}
+
+	options.threadPool->ForEach(parts.size(), [&](size_t index) { parts[index].Code(); });
+
+	for (CoderCpp& part : parts)
+	{
+		Cursor() << part.writer.GetBuffer();
+		std::ranges::move(part.headers, std::back_inserter(headers));
+		std::ranges::move(part.exports, std::back_inserter(exports));
+		std::ranges::move(part.errors, std::back_inserter(errors));
+		std::ranges::move(part.definitions, std::back_inserter(definitions));
 	}
 }
 
+void CoderCpp::CodeCached(Node& node)
+{
+	// The generated code of a declaration only depends on the declaration itself,
+	// so it's looked up in the cache by the hash of the serialized syntax tree.
+	// A cache entry holds the code, and the headers, exports, errors and definitions that the declaration adds.
+
+	std::string tree;
+	MsgPackWriter treeWriter(tree);
+	NodeSerializer::Serialize(treeWriter, node, node.token.error.line);
+	CompilationCache::Hasher hasher;
+	hasher.Add(tree).Add(options.namedLocals).Add(options.profile).Add(options.results).Add(implementation);
+
+	// The tree has lines relative to the declaration, but #line directives have absolute lines.
+	if (!options.sourceFile.empty())
+		hasher.Add(options.sourceFile).Add(node.token.error.line);
+
+	// The code of calls and declarations depends on the effects of the functions and whether they're constant,
+	// which the tree doesn't include.
+	Traverse<const Node>::DepthFirstPreorder(node, [&](const Node& n)
+		{
+			if (n.type == Node::Type::FunctionDeclaration || n.type == Node::Type::FunctionCall)
+				hasher.Add(n.callee ? n.callee->effects.flags : Effects::Unknown).Add(n.callee && n.callee->constant);
+		});
+
+	// The profile only affects the code of the declaration by the calls and heat of the function.
+	if (options.profileUse)
+		hasher.Add(options.profileUse->GetCalls(node)).Add(static_cast<uint64_t>(options.profileUse->GetHeat(node)));
+
+	const auto key = hasher.Get();
+
+	if (auto data = options.cache->Load("cpp", key))
+	{
+		try
+		{
+			MsgPackReader reader(data.value());
+			if (reader.ReadArray() != 5)
+				throw MsgPackException();
+
+			const auto code = reader.ReadString();
+			auto newHeaders = reader.ReadStringArray();
+			auto newExports = reader.ReadStringArray();
+			auto newErrors = reader.ReadStringArray();
+
+			std::vector<Definition> newDefinitions(reader.ReadArray());
+			for (auto& definition : newDefinitions)
+			{
+				if (reader.ReadArray() != 4)
+					throw MsgPackException();
+
+				definition.size = reader.ReadUInt();
+				definition.declarations = reader.ReadStringArray();
+				definition.shared = reader.ReadBool();
+				definition.calls = reader.ReadUInt();
+			}
+
+			Cursor() << code;
+			std::ranges::move(newHeaders, std::back_inserter(headers));
+			std::ranges::move(newExports, std::back_inserter(exports));
+			std::ranges::move(newErrors, std::back_inserter(errors));
+			std::ranges::move(newDefinitions, std::back_inserter(definitions));
+			return;
+		}
+		catch (const MsgPackException&)
+		{
+			// Generate the code again to replace the corrupt cache entry.
+		}
+	}
+
+	const auto headerCount = headers.size();
+	const auto exportCount = exports.size();
+	const auto errorCount = errors.size();
+	const auto definitionCount = definitions.size();
+
+	// Generate the code in a separate writer, to get the code of the declaration alone.
+	CodeWriter fragment;
+	std::swap(writer, fragment);
+	GenerateNode(node);
+	std::swap(writer, fragment);
+
+	const std::string code(fragment.GetBuffer());
+	Cursor() << code;
+
+	const auto added = [](const std::vector<std::string>& values, size_t count)
+	{
+		return std::vector<std::string>(values.begin() + count, values.end());
+	};
+
+	std::string data;
+	MsgPackWriter writer(data);
+	writer.WriteArray(5);
+	writer.WriteString(code);
+	writer.WriteStringArray(added(headers, headerCount));
+	writer.WriteStringArray(added(exports, exportCount));
+	writer.WriteStringArray(added(errors, errorCount));
+
+	writer.WriteArray(definitions.size() - definitionCount);
+	for (size_t i = definitionCount; i < definitions.size(); ++i)
+	{
+		writer.WriteArray(4);
+		writer.WriteUInt(definitions[i].size);
+		writer.WriteStringArray(definitions[i].declarations);
+		writer.WriteBool(definitions[i].shared);
+		writer.WriteUInt(definitions[i].calls);
+	}
+	options.cache->Store("cpp", key, data);
+}
+
 void CoderCpp::Visit(Node& node) noexcept
 {
-	auto& v = GetVisitors();
-	auto iter = v.find(node.type);
-	if (iter != v.end())
+	// Top-level nodes.
+	Context context;
+
+	switch (node.type)
 	{
-		Context context;
-		iter->second(this, node, context);
+	case Node::Type::Error:
+		ErrorVisitor(node, context);
+		break;
+
+	case Node::Type::FunctionDeclaration:
+		FunctionDeclarationVisitor(node, context);
+		break;
+
+	default:
+		break;
 	}
 }
 
 void CoderCpp::Visit(Context& context, Node& node)
 {
-	auto& v = GetInternalVisitors();
-	auto iter = v.find(node.type);
-	if (iter != v.end())
-		iter->second(this, node, context);
+	// Nodes in function bodies.
+	switch (node.type)
+	{
+	case Node::Type::Expression:
+		ExpressionVisitor(node, context);
+		break;
+
+	case Node::Type::ExpressionInput:
+		ExpressionInputVisitor(node, context);
+		break;
+
+	case Node::Type::FunctionCall:
+		FunctionCallVisitor(node, context);
+		break;
+
+	case Node::Type::BinaryOperation:
+		BinaryOperationVisitor(node, context);
+		break;
+
+	case Node::Type::Literal:
+		LiteralVisitor(node, context);
+		break;
+
+	case Node::Type::Tuple:
+		TupleVisitor(node, context);
+		break;
+
+	case Node::Type::VariableReference:
+		VariableReferenceVisitor(node, context);
+		break;
+
+	default:
+		break;
+	}
 }
 
 void CoderCpp::BeginScope()
@@ -95,8 +428,51 @@ void CoderCpp::ErrorVisitor(Node& node, Context&)
 	Scope() << "/* " << to_string(node.error.code) << ": " << node.error.message << " */";
 }
 
+void CoderCpp::LineDirective(const Node& node)
+{
+	if (options.sourceFile.empty())
+		return;
+
+	NewLine() << "#line " << node.token.error.line << " \"";
+
+	for (auto c : options.sourceFile)
+	{
+		if (c == '\\' || c == '"')
+			Cursor() << '\\';
+
+		Cursor() << c;
+	}
+
+	Cursor() << '"';
+}
+
+void CoderCpp::ProfilerScope(const Node& node)
+{
+	if (!options.profile)
+		return;
+
+	// The function is registered once, by its first call.
+	Scope() << "static const lovela::profiler::function profiler_function{ \"";
+
+	for (auto c : node.value.empty() ? std::string("main") : node.GetQualifiedName())
+	{
+		if (c == '\\' || c == '"')
+			Cursor() << '\\';
+
+		Cursor() << c;
+	}
+
+	Cursor() << "\" };";
+	Scope() << "const lovela::profiler::scope profiler_scope{ profiler_function };";
+}
+
 void CoderCpp::FunctionDeclarationVisitor(Node& node, Context& context)
 {
+	LineDirective(node);
+
+	if (options.profileUse && !definitions.empty())
+		definitions.back().calls += options.profileUse->GetCalls(node);
+
 	if (node.value.empty())
 	{
 		MainFunctionDeclaration(node, context);
@@ -110,13 +486,20 @@ void CoderCpp::FunctionDeclarationVisitor(Node& node, Context& context)
 	std::vector<std::string> templateParameters;
 	std::vector<std::pair<std::string, std::string>> parameters;
 
+	// A function that calls itself last is a loop, with variables for its parameters that the tail call assigns.
+	// The parameters are passed as to other functions, so that the signature matches the declarations of the function.
+	context.tailCall = GetTailCall(node);
+	std::vector<std::pair<std::string, std::string>> loopVariables;
+
 	const auto outType = ConvertType(node.outType);
 
 	if (node.outType.Is(TypeSpec::Kind::Tagged))
 		templateParameters.push_back(outType.name);
 
 	const auto inType = ConvertType(node.inType);
-	parameters.emplace_back(std::make_pair(inType.name, "in"));
+	const auto inTypeName = ParameterTypeName(node.inType, inType.name);
+	parameters.emplace_back(std::make_pair(inTypeName, "in"));
+	loopVariables.emplace_back(std::make_pair(inType.name, "in"));
 
 	if (node.inType.Is(TypeSpec::Kind::Tagged))
 		templateParameters.push_back(inType.name);
@@ -133,41 +516,115 @@ void CoderCpp::FunctionDeclarationVisitor(Node& node, Context& context)
 			templateParameters.push_back(type.name);
 		}
 
-		parameters.emplace_back(std::make_pair(type.name, name));
+		parameters.emplace_back(std::make_pair(ParameterTypeName(parameter->type, type.name), name));
+		loopVariables.emplace_back(std::make_pair(type.name, name));
 	}
 
+	// The parameters that aren't passed by value are renamed, and copied to the loop variables by the body.
+	context.tailParameters = loopVariables;
+	context.tailCopies.clear();
+
+	for (size_t i = 0; context.tailCall && i < parameters.size(); ++i)
+	{
+		if (parameters[i].first != loopVariables[i].first)
+		{
+			parameters[i].second = CopiedParameterName(parameters[i].second);
+			context.tailCopies.push_back(loopVariables[i]);
+		}
+	}
+
+	// A function that returns its input unchanged returns the reference that it was given,
+	// which is valid as long as the argument is, so callers don't copy large values twice.
+	const bool returnsInput = !node.children.empty() && node.children.front().type == Node::Type::Empty;
+	const auto& valueTypeName = returnsInput && node.outType == node.inType && inTypeName != inType.name ? inTypeName : outType.name;
+
+	// A function that may fail returns its errors with its value, see Options::results.
+	const bool returnsResult = ReturnsResult(node);
+	const auto outTypeName = returnsResult ? "lovela::result<" + outType.name + '>' : valueTypeName;
+	context.failure = returnsResult ? Context::Failure::Return : Context::Failure::Throw;
+
+	std::string templateDeclaration;
+
 	if (!templateParameters.empty())
 	{
-		Scope() << "template <";
+		templateDeclaration = "template <";
 
 		index = 0;
 		for (auto& param : templateParameters)
 		{
 			if (index++)
-				Cursor() << ',' << ' ';
+				templateDeclaration += ", ";
 
-			Cursor() << "typename " << param;
+			templateDeclaration += "typename " + param;
 		}
 
-		Cursor() << '>';
+		templateDeclaration += '>';
+		Scope() << templateDeclaration;
 	}
 
-	Scope() << outType.name << ' ' << FunctionName(node.value) << "(lovela::context& context";
+	// Functions that the analyzer found constant can be evaluated by the C++ compiler at compile time,
+	// but constexpr functions can't have the static local of the profiler.
+	const bool constant = node.callee && node.callee->constant && !options.profile;
 
-	for (auto& parameter : parameters)
-		Cursor() << ',' << ' ' << parameter.first << ' ' << parameter.second;
+	std::string signature = (constant ? "constexpr " : "") + outTypeName + ' ' + FunctionName(node.value) + '(' + (TakesContext(node) ? "lovela::context& context, " : "");
 
-	Cursor() << ')';
+	for (bool sep{}; auto& parameter : parameters)
+	{
+		signature += (sep ? ", " : "") + parameter.first + ' ' + parameter.second;
+		sep = true;
+	}
+
+	signature += ')';
+
+	std::string_view attribute;
+	if (options.profileUse)
+	{
+		switch (options.profileUse->GetHeat(node))
+		{
+		case Profile::Heat::Hot:
+			attribute = "LOVELA_HOT ";
+			break;
+
+		case Profile::Heat::Cold:
+			attribute = "LOVELA_COLD ";
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	Scope() << attribute << signature;
+
+	// Declare the function in the shared header of a split program.
+	// C++ requires the definitions of templates, of functions with deduced return types and of constexpr functions
+	// where they are called, so such functions are also defined in the header.
+	if (!definitions.empty())
+	{
+		const bool deduced = !templateParameters.empty() || outTypeName.starts_with(TypeNames::any)
+			|| std::ranges::any_of(parameters, [](auto& parameter) { return parameter.first.starts_with(TypeNames::any); });
+
+		auto& definition = definitions.back();
+		definition.declarations.push_back((templateDeclaration.empty() ? "" : templateDeclaration + ' ') + std::string(attribute) + (deduced ? "inline " : "") + signature);
+		definition.shared = definition.shared || deduced || constant;
+	}
 
 	if (node.apiSpec.Is(ApiSpec::Import))
 		ImportedFunctionBody(node, context, parameters);
+	else if (!implementation.empty() && !node.children.empty())
+		ForwardingBody(node, templateParameters, parameters);
 	else
 		FunctionBody(node, context);
 
 	// Generate the exported function
 
 	if (node.apiSpec.Is(ApiSpec::Export))
+	{
+		// The exported function is defined once, also if the function that it calls is defined in the shared header.
+		BeginDefinition();
+		LineDirective(node);
 		ExportedFunctionDeclaration(node, context);
+	}
 }
 
 void CoderCpp::MainFunctionDeclaration(Node& node, Context& context)
@@ -179,6 +636,7 @@ void CoderCpp::MainFunctionDeclaration(Node& node, Context& context)
 	}
 
 	Scope() << TypeNames::none << ' ' << "lovela::main(lovela::context& context, " << TypeNames::none << " in)";
+	context.failure = Context::Failure::Main;
 	FunctionBody(node, context);
 }
 
@@ -202,13 +660,31 @@ std::optional<TypeSpec> CoderCpp::CheckExportType(const TypeSpec& type)
 		}
 
 		auto converted = type;
-		converted.name = name.value();
+		converted.SetName(name.value());
 		return converted;
 	}
 	}
 }
 
 std::optional<std::string> CoderCpp::ConvertPrimitiveType(const TypeSpec& type)
+{
+	return type.id ? GetCachedName(exportTypeNames, type, GetExportTypeName) : GetExportTypeName(type);
+}
+
+const std::string& CoderCpp::GetCachedName(std::vector<std::string>& names, const TypeSpec& type, std::string (*getName)(const TypeSpec&))
+{
+	// The names of interned types are generated once by each coder, and looked up by id.
+	if (names.size() < type.id)
+		names.resize(type.id);
+
+	auto& name = names[type.id - 1];
+	if (name.empty())
+		name = getName(type);
+
+	return name;
+}
+
+std::string CoderCpp::GetExportTypeName(const TypeSpec& type)
 {
 	static const std::map<std::string, std::string> types
 	{
@@ -216,7 +692,7 @@ std::optional<std::string> CoderCpp::ConvertPrimitiveType(const TypeSpec& type)
 		{"[/type/i8]#", "l_cstr"},
 	};
 
-	auto it = types.find(type.GetQualifiedName());
+	auto it = types.find(type.FormatQualifiedName());
 	if (it != types.end())
 		return it->second;
 
@@ -235,11 +711,32 @@ std::optional<std::string> CoderCpp::ConvertPrimitiveType(const TypeSpec& type)
 TypeSpec CoderCpp::ConvertType(const TypeSpec& type)
 {
 	TypeSpec converted = type;
-	converted.name = ConvertTypeName(type);
+	converted.SetName(ConvertTypeName(type));
 	return converted;
 }
 
 std::string CoderCpp::ConvertTypeName(const TypeSpec& type)
+{
+	switch (type.kind)
+	{
+	case TypeSpec::Kind::Any:
+	case TypeSpec::Kind::None:
+	case TypeSpec::Kind::Tagged:
+	case TypeSpec::Kind::Named:
+	case TypeSpec::Kind::Primitive:
+		return type.id ? GetCachedName(typeNames, type, GetTypeName) : GetTypeName(type);
+
+	case TypeSpec::Kind::Invalid:
+		errors.emplace_back("Error: Invalid type encountered at code generation.");
+		return TypeNames::invalid;
+
+	default:
+		errors.emplace_back(fmt::format("Error: Unhandled type kind \"{}\" when getting the target type name.", to_string(type.kind)));
+		return TypeNames::invalid;
+	}
+}
+
+std::string CoderCpp::GetTypeName(const TypeSpec& type)
 {
 	switch (type.kind)
 	{
@@ -256,15 +753,56 @@ std::string CoderCpp::ConvertTypeName(const TypeSpec& type)
 		return "t_" + type.name;
 
 	case TypeSpec::Kind::Primitive:
-		return ConvertPrimitiveType(type).value_or(TypeNames::invalid);
+		return GetExportTypeName(type);
 
-	case TypeSpec::Kind::Invalid:
-		errors.emplace_back("Error: Invalid type encountered at code generation.");
+	default:
 		return TypeNames::invalid;
+	}
+}
+
+std::string CoderCpp::FormatSignature(std::string_view outType, std::string_view name, const std::vector<std::pair<std::string, std::string>>& parameters)
+{
+	fmt::memory_buffer signature;
+	fmt::format_to(std::back_inserter(signature), "{} {}(", outType, name);
+
+	for (bool sep{}; auto& [type, parameterName] : parameters)
+	{
+		fmt::format_to(std::back_inserter(signature), "{}{} {}", sep ? ", " : "", type, parameterName);
+		sep = true;
+	}
+
+	signature.push_back(')');
+	return fmt::to_string(signature);
+}
+
+std::string CoderCpp::CopiedParameterName(const std::string& name)
+{
+	return name + "_arg";
+}
+
+std::string CoderCpp::ParameterTypeName(const TypeSpec& type, const std::string& name)
+{
+	switch (type.kind)
+	{
+	case TypeSpec::Kind::Any:
+	case TypeSpec::Kind::Tagged:
+		// The argument type is deduced, and may be of any size.
+		// A forwarding reference doesn't copy, and lets a value that the caller moves be moved on.
+		return name + "&&";
+
+	case TypeSpec::Kind::Named:
+		// The size of a named type is only known by the C++ compiler.
+		return "lovela::param_t<" + name + '>';
+
+	case TypeSpec::Kind::Primitive:
+	{
+		// Arrays are passed as pointers.
+		const size_t size = type.arrayDims.empty() ? type.primitive.bits / 8 : sizeof(void*);
+		return size <= MaxValueSize ? name : "const " + name + '&';
+	}
 
 	default:
-		errors.emplace_back(fmt::format("Error: Unhandled type kind \"{}\" when getting the target type name.", to_string(type.kind)));
-		return TypeNames::invalid;
+		return name;
 	}
 }
 
@@ -283,6 +821,98 @@ std::string CoderCpp::FunctionName(const std::string& name)
 	return "f_" + name;
 }
 
+CoderCpp::InputUses CoderCpp::GetInputUses(Node& operation)
+{
+	InputUses uses;
+
+	Traverse<Node>::DepthFirstPreorder(operation, [&](Node& node)
+		{
+			if (node.type == Node::Type::ExpressionInput)
+			{
+				++uses.inputs;
+			}
+			else if (node.type == Node::Type::FunctionCall)
+			{
+				++uses.calls;
+				uses.arguments += !node.children.empty() && node.children.front().type == Node::Type::ExpressionInput;
+			}
+		});
+
+	return uses;
+}
+
+bool CoderCpp::TakesContext(const Node& function)
+{
+	// Only pure functions don't need the context. Imported functions and the functions that call them
+	// keep it, so that they can report errors. The effects are unknown if the analyzer hasn't resolved the function.
+	return !function.callee || !function.callee->effects.IsPure();
+}
+
+bool CoderCpp::ReturnsResult(const Node& function) const
+{
+	// In the results mode, the functions of the program that may fail return a lovela::result, if the type of their value is known.
+	// A function may fail if it calls a function that the program doesn't define, which uses the context.
+	// The functions that the program doesn't define are C++ functions that return plain values, see CatchesErrors.
+	if (!options.results || !function.callee)
+		return false;
+
+	const auto& callee = *function.callee;
+	return callee.defined && callee.effects.Is(Effects::Context) && !callee.outType.Is(TypeSpec::Kind::Any);
+}
+
+bool CoderCpp::CatchesErrors(const Node& call) const
+{
+	// In the results mode, the errors that the functions that the program doesn't define throw
+	// are converted to a lovela::result at the call. Imported functions don't throw lovela errors.
+	if (!options.results || call.type != Node::Type::FunctionCall)
+		return false;
+
+	return !call.callee || (!call.callee->defined && !call.callee->apiSpec.Is(ApiSpec::Import));
+}
+
+bool CoderCpp::MayFail(const Node& call) const
+{
+	return ReturnsResult(call) || CatchesErrors(call);
+}
+
+const Node* CoderCpp::GetTailCall(const Node& function)
+{
+	if (function.children.empty() || function.apiSpec.Is(ApiSpec::Import))
+		return nullptr;
+
+	const auto& body = function.children.front();
+	if (body.type != Node::Type::Expression || body.children.empty() || body.children.back().type != Node::Type::FunctionCall)
+		return nullptr;
+
+	// The analyzer resolves the called function, otherwise it's called by its name.
+	const auto& call = body.children.back();
+	if (call.callee ? call.callee != function.callee : call.value != function.value || call.nameSpace != function.nameSpace)
+		return nullptr;
+
+	size_t argumentCount = 0;
+	if (call.children.size() > 1)
+		argumentCount = call.children[1].type == Node::Type::Tuple ? call.children[1].children.size() : call.children[1].type == Node::Type::Empty ? 0 : 1;
+
+	if (argumentCount != function.parameters.size())
+		return nullptr;
+
+	// The types of the loop variables must be the same in each iteration, which they might not be for function templates.
+	const auto concrete = [](const TypeSpec& type) { return !type.Is(TypeSpec::Kind::Any) && !type.Is(TypeSpec::Kind::Tagged); };
+	if (!concrete(function.inType) || !concrete(function.outType) || !std::ranges::all_of(function.parameters, [&](auto& parameter) { return concrete(parameter->type); }))
+		return nullptr;
+
+	return &call;
+}
+
+std::string CoderCpp::MoveInput(size_t index)
+{
+	// The first local is a reference to the input, which is forwarded as the caller passed it.
+	if (index == 1)
+		return fmt::format("std::forward<decltype(in)>({}{})", LocalVar, index);
+
+	return fmt::format("std::move({}{})", LocalVar, index);
+}
+
 std::string CoderCpp::RefVar(char prefix, size_t index)
 {
 	return std::string("static_cast<void>(") + prefix + to_string(index) + ')';
@@ -329,37 +959,23 @@ void CoderCpp::ExportedFunctionDeclaration(Node& node, Context&)
 
 	// Make the function signature
 
-	std::stringstream ss;
-	ss << outType.name << ' ' << node.value << '(';
-
-	index = 0;
-	for (auto& parameter : parameters)
-	{
-		if (index++)
-			ss << ',' << ' ';
-
-		ss << parameter.first << ' ' << parameter.second;
-	}
-
-	ss << ')';
-
-	auto signature = ss.str();
+	const auto signature = FormatSignature(outType.name, node.value, parameters);
 
 	// Store export declaration
 
-	std::ostringstream exportDeclaration;
+	std::string exportDeclaration;
 
 	if (node.apiSpec.Is(ApiSpec::C))
-		exportDeclaration << "LOVELA_API_C ";
+		exportDeclaration += "LOVELA_API_C ";
 	else if (node.apiSpec.Is(ApiSpec::Cpp))
-		exportDeclaration << "LOVELA_API_CPP ";
+		exportDeclaration += "LOVELA_API_CPP ";
 
 	if (node.apiSpec.Is(ApiSpec::Dynamic))
-		exportDeclaration << "LOVELA_API_DYNAMIC_EXPORT ";
+		exportDeclaration += "LOVELA_API_DYNAMIC_EXPORT ";
 
-	exportDeclaration << signature;
+	exportDeclaration += signature;
 
-	exports.push_back(exportDeclaration.str());
+	exports.push_back(std::move(exportDeclaration));
 
 	// Define the exported function wrapper
 
@@ -367,23 +983,38 @@ void CoderCpp::ExportedFunctionDeclaration(Node& node, Context&)
 
 	BeginScope();
 
-	Scope() << "lovela::context context;";
+	const bool takesContext = TakesContext(node);
+	if (takesContext)
+		Scope() << "lovela::context context;";
 
 	if (inType.Is(TypeSpec::Kind::None))
 		Scope() << TypeNames::none << " in;";
 
 	// Call the actual function
 
-	Scope() << (node.outType.Is(TypeSpec::Kind::None) ? "" : "return ") << FunctionName(node.value) << "(context";
+	const bool returnsResult = ReturnsResult(node);
+	Scope() << (returnsResult ? "const auto result = " : node.outType.Is(TypeSpec::Kind::None) ? "" : "return ") << FunctionName(node.value) << '(' << (takesContext ? "context, " : "");
 
 	if (inType.Is(TypeSpec::Kind::None))
-		Cursor() << ", in";
+		Cursor() << "in" << (parameters.empty() ? "" : ", ");
 
-	for (auto& parameter : parameters)
-		Cursor() << ',' << ' ' << parameter.second;
+	for (bool sep{}; auto& parameter : parameters)
+	{
+		Cursor() << (sep ? ", " : "") << parameter.second;
+		sep = true;
+	}
 
 	Cursor() << ')' << ';';
 
+	// The exported function has no result, so its caller gets the error as an exception, as from the other functions.
+	if (returnsResult)
+	{
+		Scope() << "if (!result) { throw lovela::error(result.error().message(), result.error().code()); }";
+
+		if (!node.outType.Is(TypeSpec::Kind::None))
+			Scope() << "return *result;";
+	}
+
 	EndScope();
 }
 
@@ -447,21 +1078,7 @@ void CoderCpp::ImportedFunctionDeclaration(Node& node, Context&)
 
 	// Make the function signature
 
-	std::stringstream ss;
-	ss << outType.name << ' ' << node.value << '(';
-
-	index = 0;
-	for (auto& parameter : parameters)
-	{
-		if (index++)
-			ss << ',' << ' ';
-
-		ss << parameter.first << ' ' << parameter.second;
-	}
-
-	ss << ')';
-
-	auto signature = ss.str();
+	const auto signature = FormatSignature(outType.name, node.value, parameters);
 
 	// Declare import
 
@@ -486,15 +1103,34 @@ void CoderCpp::FunctionBody(Node& node, Context& context)
 	{
 		BeginScope();
 
-		Scope() << "static_cast<void>(context);";
+		if (TakesContext(node))
+			Scope() << "static_cast<void>(context);";
+
+		ProfilerScope(node);
+
+		// The C++ compiler can't be relied on to eliminate the tail call, so a function that calls itself last is a loop
+		// that assigns the arguments of the call to the parameters. Lovela has no branches, so only errors end the loop.
+		if (context.tailCall)
+		{
+			for (auto& [type, name] : context.tailCopies)
+				Scope() << type << ' ' << name << " = " << CopiedParameterName(name) << ';';
+
+			Scope() << "for (;;)";
+			BeginScope();
+		}
 
 		// Make an indexed reference to the input object and avoid a warning if it's unreferenced.
 		Scope() << "auto& " << LocalVar << ++context.variableIndex << " = in; " << RefVar(LocalVar, context.variableIndex) << ';';
 
 		Visit(context, node.children, 0, 1);
 
-		if (node.outType.Is(TypeSpec::Kind::None))
+		// Locals are moved when returned, but the input is a reference.
+		if (context.tailCall)
+			EndScope();
+		else if (node.outType.Is(TypeSpec::Kind::None))
 			Scope() << "return {};";
+		else if (context.variableIndex == 1)
+			Scope() << "return " << MoveInput(context.variableIndex) << ';';
 		else
 			Scope() << "return " << LocalVar << context.variableIndex << ';';
 
@@ -508,11 +1144,46 @@ void CoderCpp::FunctionBody(Node& node, Context& context)
 	}
 }
 
+void CoderCpp::ForwardingBody(Node& node, const std::vector<std::string>& templateParameters, const std::vector<std::pair<std::string, std::string>>& parameters)
+{
+	// The implementation has the same signature, so the arguments are passed on as they were given.
+	BeginScope();
+
+	Scope() << "return " << FunctionName(implementation);
+
+	for (bool sep{}; auto& parameter : templateParameters)
+	{
+		Cursor() << (sep ? ", " : "<") << parameter;
+		sep = true;
+	}
+
+	Cursor() << (templateParameters.empty() ? "(" : ">(") << (TakesContext(node) ? "context, " : "");
+
+	for (bool sep{}; auto& [type, name] : parameters)
+	{
+		Cursor() << (sep ? ", " : "");
+
+		if (type.ends_with("&&"))
+			Cursor() << "std::forward<decltype(" << name << ")>(" << name << ')';
+		else
+			Cursor() << name;
+
+		sep = true;
+	}
+
+	Cursor() << ')' << ';';
+
+	EndScope();
+
+	NewLine();
+}
+
 void CoderCpp::ImportedFunctionBody(Node& node, Context&, const std::vector<std::pair<std::string, std::string>>& parameters)
 {
 	BeginScope();
 
-	Scope() << "static_cast<void>(context);";
+	if (TakesContext(node))
+		Scope() << "static_cast<void>(context);";
 
 	if (!node.outType.Is(TypeSpec::Kind::None))
 		Scope() << "return ";
@@ -540,30 +1211,231 @@ void CoderCpp::ImportedFunctionBody(Node& node, Context&, const std::vector<std:
 
 void CoderCpp::ExpressionVisitor(Node& node, Context& context)
 {
-	Visit(context, node.children);
+	if (context.inner)
+	{
+		Visit(context, node.children);
+		return;
+	}
+
+	auto& operations = node.children;
+
+	// The calls that may fail can't be nested in the next operation, since their results are checked first.
+	const auto mayFail = [this](Node& operation)
+	{
+		bool fails = false;
+		if (options.results)
+			Traverse<Node>::DepthFirstPreorder(operation, [&](Node& n) { fails = fails || (n.type == Node::Type::FunctionCall && MayFail(n)); });
+		return fails;
+	};
+
+	for (size_t first = 0; first < operations.size();)
+	{
+		// Operations that use the value of the previous operation once are nested in the same statement,
+		// so that the value is passed on as a prvalue instead of through a local.
+		// Other function calls in the operation could have side effects, which would then be reordered.
+		size_t last = first;
+		while (!options.namedLocals && last + 1 < operations.size() && !mayFail(operations[last]))
+		{
+			const auto& next = operations[last + 1];
+			const auto uses = GetInputUses(operations[last + 1]);
+			if (uses.inputs != 1 || uses.calls != (next.type == Node::Type::FunctionCall ? 1 : 0))
+				break;
+
+			++last;
+		}
+
+		// Each statement is assigned to a new local, and the expression inputs in its first operation all refer to the previous local,
+		// which isn't used after the statement. It can be moved if it's used once, since the order of evaluation of arguments is unspecified.
+		// Only function arguments are moved, since the operands of binary operations are mostly primitive values.
+		const auto uses = GetInputUses(operations[first]);
+		context.moveInput = uses.inputs == 1 && uses.arguments == 1;
+		context.fused = std::span(operations).subspan(first, last - first);
+
+		LineDirective(operations[first]);
+
+		// The results of the calls in the operation that may fail are checked before the operation uses their values.
+		if (options.results)
+		{
+			Traverse<Node>::DepthFirstPostorder(operations[last], [&](Node& n)
+				{
+					if (&n != &operations[last] && n.type == Node::Type::FunctionCall && MayFail(n))
+						AssignResult(n, context);
+				});
+		}
+
+		Visit(context, operations[last]);
+
+		first = last + 1;
+	}
+
+	context.moveInput = false;
+	context.fused = {};
 }
 
 void CoderCpp::ExpressionInputVisitor(Node&, Context& context)
 {
+	if (!context.fused.empty())
+	{
+		// The input is the value of the previous operation, which is nested here.
+		auto& operation = context.fused.back();
+		const auto fused = std::exchange(context.fused, context.fused.first(context.fused.size() - 1));
+		const bool binary = operation.type == Node::Type::BinaryOperation;
+
+		if (binary)
+			Cursor() << '(';
+
+		Visit(context, operation);
+
+		if (binary)
+			Cursor() << ')';
+
+		context.fused = fused;
+		return;
+	}
+
 	// The input of an expression is the output of the previous expression.
-	Cursor() << LocalVar << (context.variableIndex - 1);
+	const auto index = context.variableIndex - 1;
+
+	if (context.moveInput)
+		Cursor() << MoveInput(index);
+	else
+		Cursor() << LocalVar << index;
 }
 
 void CoderCpp::FunctionCallVisitor(Node& node, Context& context)
 {
+	if (&node == context.tailCall)
+	{
+		TailCall(node, context);
+		return;
+	}
+
+	if (MayFail(node))
+	{
+		// The value of a call that may fail is used after its result has been checked.
+		if (const auto result = context.results.find(&node); result != context.results.end())
+		{
+			Cursor() << "*std::move(" << ResultVar << result->second << ')';
+			return;
+		}
+
+		if (!context.inner)
+		{
+			const auto result = AssignResult(node, context);
+			BeginAssign(context);
+			Cursor() << "*std::move(" << ResultVar << result << ')';
+			EndAssign(context);
+			return;
+		}
+	}
+
 	const auto reset = BeginAssign(context, true);
+	CallExpression(node, context);
+	EndAssign(context, reset);
+}
 
-	Cursor() << FunctionName(node.value) << "(context";
+void CoderCpp::CallExpression(Node& node, Context& context)
+{
+	Cursor() << FunctionName(node.value) << '(' << (TakesContext(node) ? "context" : "");
 
-	for (auto& parameter : node.children)
+	for (bool sep = TakesContext(node); auto& parameter : node.children)
 	{
-		Cursor() << ',' << ' ';
+		if (sep)
+			Cursor() << ',' << ' ';
+		sep = true;
+
 		Visit(context, parameter);
 	}
 
 	Cursor() << ')';
+}
 
-	EndAssign(context, reset);
+size_t CoderCpp::AssignResult(Node& call, Context& context)
+{
+	// The result is assigned before the local of the operation, so the input of the call is the previous local, as if it were assigned.
+	++context.variableIndex;
+	const auto reset = std::exchange(context.inner, true);
+	const auto index = ++context.resultIndex;
+
+	// The errors that a function that the program doesn't define throws are caught, so that they are returned as the other errors.
+	const bool catches = CatchesErrors(call);
+	Scope() << "auto " << ResultVar << index << " = " << (catches ? "lovela::attempt([&] { return " : "");
+	CallExpression(call, context);
+	Cursor() << (catches ? "; })" : "") << "; if (!" << ResultVar << index << ") { ";
+
+	// The error is passed on to the caller, or set in the context by main, which ends the program.
+	switch (context.failure)
+	{
+	case Context::Failure::Return:
+		Cursor() << "return lovela::fail(" << ResultVar << index << ".error());";
+		break;
+
+	case Context::Failure::Main:
+		Cursor() << "context.error = lovela::error(" << ResultVar << index << ".error().message(), " << ResultVar << index << ".error().code()); return {};";
+		break;
+
+	default:
+		Cursor() << "throw lovela::error(" << ResultVar << index << ".error().message(), " << ResultVar << index << ".error().code());";
+		break;
+	}
+
+	Cursor() << " }";
+
+	context.inner = reset;
+	--context.variableIndex;
+	context.results.emplace(&call, index);
+	return index;
+}
+
+void CoderCpp::TailCall(Node& node, Context& context)
+{
+	// The arguments are converted to the parameter types as by the call, and may refer to the parameters,
+	// so they are all evaluated to temporaries before any parameter is assigned.
+	const auto reset = std::exchange(context.inner, true);
+	const auto& parameters = context.tailParameters;
+
+	// The input of the call is the previous local, as if the call were assigned to a new local.
+	++context.variableIndex;
+
+	if (parameters.size() == 1)
+	{
+		Scope() << parameters.front().second << " = " << parameters.front().first << '(';
+	}
+	else
+	{
+		Scope() << "std::tie(";
+
+		for (bool sep{}; auto& parameter : parameters)
+		{
+			Cursor() << (sep ? ", " : "") << parameter.second;
+			sep = true;
+		}
+
+		Cursor() << ") = std::tuple<";
+
+		for (bool sep{}; auto& parameter : parameters)
+		{
+			Cursor() << (sep ? ", " : "") << parameter.first;
+			sep = true;
+		}
+
+		Cursor() << ">(";
+	}
+
+	for (bool sep{}; auto& argument : node.children)
+	{
+		if (argument.type == Node::Type::Empty)
+			continue;
+
+		Cursor() << (sep ? ", " : "");
+		sep = true;
+
+		Visit(context, argument);
+	}
+
+	Cursor() << ");";
+
+	context.inner = reset;
 }
 
 void CoderCpp::BinaryOperationVisitor(Node& node, Context& context)
@@ -610,7 +1482,7 @@ void CoderCpp::VariableReferenceVisitor(Node& node, Context&)
 void CoderCpp::BeginAssign(Context& context)
 {
 	if (!context.inner)
-		Scope() << "const auto " << LocalVar << ++context.variableIndex << " = ";
+		Scope() << "auto " << LocalVar << ++context.variableIndex << " = ";
 }
 
 bool CoderCpp::BeginAssign(Context& context, bool inner)
@@ -667,11 +1539,204 @@ void CoderCpp::GenerateExportsFile(std::ostream& file) const
 )cpp";
 }
 
+std::string CoderCpp::GetRuntimeInclude() const
+{
+	// lovela.h doesn't include the results, which require C++23.
+	const std::string results = options.results ? "#include \"lovela-result.h\"\n" : "";
+
+	switch (options.runtime)
+	{
+	case Runtime::PrecompiledHeader:
+		return "#include \"lovela-runtime-pch.h\"\n" + results;
+
+	case Runtime::Module:
+		// lovela-program.h imports the module after the other headers.
+		return "#define LOVELA_RUNTIME_MODULE\n" + results;
+
+	default:
+		return results;
+	}
+}
+
 void CoderCpp::GenerateProgramFile(std::ostream& file) const
 {
-	file << R"cpp(
+	file << '\n' << GetRuntimeInclude() << "#include \"lovela-program.h\"\n";
+
+	file << streamPtr->rdbuf();
+}
+
+std::vector<std::string> CoderCpp::SplitProgram(size_t fileCount) const
+{
+	fileCount = std::max<size_t>(fileCount, 1);
+
+	// Read the program from the start, also if it has been read before.
+	auto& buffer = *streamPtr->rdbuf();
+	buffer.pubseekpos(0, std::ios::in);
+	const std::string program{ std::istreambuf_iterator<char>(&buffer), {} };
+
+	size_t programSize = 0;
+	size_t sourceSize = 0;
+	for (auto& definition : definitions)
+	{
+		programSize += definition.size;
+		if (!definition.shared)
+			sourceSize += definition.size;
+	}
+
+	if (program.size() != programSize)
+		throw std::runtime_error("The generated program can't be read from the output stream.");
+
+	std::vector<std::string> files{ R"cpp(
+// Automatically generated header with the declarations that the source files of the lovela program share.
+#ifndef LOVELA_PROGRAM_DECLARATIONS
+#define LOVELA_PROGRAM_DECLARATIONS
 #include "lovela-program.h"
+)cpp" };
+
+	files.resize(fileCount + 1, fmt::format("\n{}#include \"lovela-program-declarations.h\"\n", GetRuntimeInclude()));
+
+	for (auto& definition : definitions)
+	{
+		for (auto& declaration : definition.declarations)
+			files.front() += '\n' + declaration + ';';
+	}
+
+	files.front() += '\n';
+
+	std::vector<std::pair<const Definition*, std::string_view>> codes;
+	size_t offset = 0;
+
+	for (auto& definition : definitions)
+	{
+		codes.emplace_back(&definition, std::string_view(program).substr(offset, definition.size));
+		offset += definition.size;
+	}
+
+	// The most called functions of the profile are defined first, so that they're together in the built program.
+	// The source files only depend on the shared header, so the order of their definitions doesn't matter otherwise.
+	if (options.profileUse)
+		std::ranges::stable_sort(codes, std::ranges::greater{}, [](auto& code) { return code.first->calls; });
+
+	// Consecutive definitions are kept together, and the source files get about the same amount of code.
+	size_t sourceOffset = 0;
+
+	for (auto& [definition, code] : codes)
+	{
+		if (definition->shared)
+		{
+			files.front() += code;
+		}
+		else
+		{
+			files[1 + std::min(sourceOffset * fileCount / std::max<size_t>(sourceSize, 1), fileCount - 1)] += code;
+			sourceOffset += definition->size;
+		}
+	}
+
+	files.front() += R"cpp(
+#endif
 )cpp";
 
-	file << streamPtr->rdbuf();
+	return files;
+}
+
+std::vector<std::filesystem::path> CoderCpp::GenerateProgramFiles(const std::filesystem::path& directory, size_t fileCount, size_t unitySize) const
+{
+	const auto files = SplitProgram(fileCount);
+	write_if_changed(directory / "lovela-program-declarations.h", files.front());
+
+	std::vector<std::filesystem::path> sources;
+
+	for (size_t i = 1; i < files.size(); ++i)
+	{
+		sources.push_back(directory / fmt::format("lovela-program-{}.cpp", i));
+		write_if_changed(sources.back(), files[i]);
+	}
+
+	if (unitySize <= 1)
+		return sources;
+
+	std::vector<std::filesystem::path> batches;
+
+	for (size_t i = 0; i < sources.size(); i += unitySize)
+	{
+		std::string batch = R"cpp(
+// Automatically generated unity build of source files of the lovela program.
+)cpp";
+
+		for (size_t j = i; j < std::min(i + unitySize, sources.size()); ++j)
+			batch += fmt::format("#include \"{}\"\n", sources[j].filename().string());
+
+		batches.push_back(directory / fmt::format("lovela-program-unity-{}.cpp", batches.size() + 1));
+		write_if_changed(batches.back(), batch);
+	}
+
+	return batches;
+}
+
+void CoderCpp::GeneratePerfMap(std::istream& symbols, std::ostream& perfMap, const std::vector<Node>& nodes, uint64_t loadAddress)
+{
+	// Functions in different namespaces may have the same C++ name.
+	std::unordered_map<std::string, std::string> names;
+
+	for (auto& node : nodes)
+	{
+		if (node.type != Node::Type::FunctionDeclaration || node.value.empty())
+			continue;
+
+		auto& name = names[FunctionName(node.value)];
+		name += (name.empty() ? "" : " | ") + node.GetQualifiedName();
+	}
+
+	const auto parseHex = [](std::string_view field, uint64_t& value)
+	{
+		const auto end = field.data() + field.size();
+		const auto [ptr, ec] = std::from_chars(field.data(), end, value, 16);
+		return !field.empty() && ec == std::errc{} && ptr == end;
+	};
+
+	// Each line is "<address> <size> <type> <signature>", where nm pads the size to the width of the address.
+	// Symbols without size, "<address> <type> <signature>", have no code, and other lines are skipped.
+	std::string line;
+
+	while (std::getline(symbols, line))
+	{
+		std::istringstream fields(line);
+		std::string address, size, type;
+		uint64_t addressValue{}, sizeValue{};
+		if (!(fields >> address >> size >> type) || size.size() != address.size() || type.size() != 1
+			|| !parseHex(address, addressValue) || !parseHex(size, sizeValue) || !sizeValue)
+			continue;
+
+		std::string signature;
+		std::getline(fields >> std::ws, signature);
+
+		const auto [name, templateArguments] = ParseFunctionName(signature);
+		const auto iter = names.find(std::string(name));
+		if (iter == names.end())
+			continue;
+
+		perfMap << fmt::format("{:x} {} {}{}\n", addressValue + loadAddress, size, iter->second, templateArguments);
+	}
+}
+
+bool CoderCpp::GenerateImportsFile(const std::filesystem::path& path) const
+{
+	std::ostringstream file;
+	GenerateImportsFile(file);
+	return write_if_changed(path, file.str());
+}
+
+bool CoderCpp::GenerateExportsFile(const std::filesystem::path& path) const
+{
+	std::ostringstream file;
+	GenerateExportsFile(file);
+	return write_if_changed(path, file.str());
+}
+
+bool CoderCpp::GenerateProgramFile(const std::filesystem::path& path) const
+{
+	std::ostringstream file;
+	GenerateProgramFile(file);
+	return write_if_changed(path, file.str());
 }
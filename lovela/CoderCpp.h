@@ -1,9 +1,65 @@
 #pragma once
 #include "ICoder.h"
+#include "CompilationCache.h"
+#include "CodeWriter.h"
+#include "ThreadPool.h"
+#include "Profile.h"
 
 class CoderCpp : public ICoder
 {
 public:
+	// How the generated source files get the lovela runtime.
+	enum class Runtime
+	{
+		// Include lovela.h.
+		Header,
+		// Include lovela-runtime-pch.h first, so that it can be used as precompiled header.
+		PrecompiledHeader,
+		// Define LOVELA_RUNTIME_MODULE, so that lovela-program.h imports the lovela.runtime module of lovela-runtime.ixx.
+		Module,
+	};
+
+	struct Options
+	{
+		// Caches the generated code of top-level declarations, if set.
+		std::shared_ptr<CompilationCache> cache;
+
+		// Generates the code of top-level declarations in parallel, if set.
+		// The output is the same as when generated sequentially.
+		std::shared_ptr<ThreadPool> threadPool;
+
+		// Assigns the value of each operation to a named local, which is easier to follow in a debugger.
+		// By default, values that are used once are passed directly to the next operation.
+		bool namedLocals = false;
+
+		// How the program files get the lovela runtime.
+		Runtime runtime = Runtime::Header;
+
+		// Emits #line directives that map the generated functions and statements to the lines of this lovela source file, if set.
+		// Debuggers and profilers then show the lovela source instead of the generated code.
+		std::string sourceFile;
+
+		// Counts the calls and measures the time of each function with lovela::profiler of lovela-profiler.h.
+		// The program writes the report to stderr when it exits, as JSON if the LOVELA_PROFILE environment variable is json.
+		bool profile = false;
+
+		// Declares the hot functions of the profile with LOVELA_HOT and the functions that weren't called with LOVELA_COLD,
+		// which lovela-api.h defines as the hot and cold attributes, so that the C++ compiler optimizes and places them accordingly.
+		// The source files of a split program get the definitions of the most called functions first, so that they're together.
+		std::shared_ptr<const Profile> profileUse;
+
+		// Defines the functions whose code is the same as that of an earlier function, apart from the names, as calls of the earlier function,
+		// which the C++ compiler inlines, so that the program has one implementation of the code.
+		// The functions aren't deduplicated with Options::profile, which measures each function separately.
+		bool deduplicate = false;
+
+		// Returns the errors of the functions that may fail as lovela::result of lovela-result.h, which requires C++23,
+		// instead of throwing lovela::error, and the callers pass them on with a branch after each call that may fail.
+		// A function may fail if it uses the context, see Effects::Context, so the analyzer must have found the effects.
+		// Functions whose out type is neither declared nor inferred throw the errors instead, and main sets them in the context.
+		bool results = false;
+	} options;
+
 	CoderCpp() noexcept = default;
 	CoderCpp(OutputT& output) noexcept;
 
@@ -35,13 +91,89 @@ public:
 	void GenerateImportsFile(std::ostream& file) const;
 	void GenerateExportsFile(std::ostream& file) const;
 
+	// Generates the file, and writes it only if its content has changed.
+	// Returns true if the file was written.
+	bool GenerateProgramFile(const std::filesystem::path& path) const;
+	bool GenerateImportsFile(const std::filesystem::path& path) const;
+	bool GenerateExportsFile(const std::filesystem::path& path) const;
+
+	// Splits the program into the given number of source files, so that the C++ compiler can build them in parallel.
+	// The source files share a header with the declarations of all functions,
+	// and the definitions of the templates and the functions with deduced return types, which C++ requires where they are called.
+	// Returns the code of the header, followed by the code of each source file.
+	[[nodiscard]] std::vector<std::string> SplitProgram(size_t fileCount) const;
+
+	// Writes the split program to lovela-program-declarations.h and lovela-program-<n>.cpp, and only the files that have changed.
+	// If the unity size is larger than one, lovela-program-unity-<n>.cpp files that include that number of source files each
+	// are also written, to build the program in fewer and larger batches.
+	// Returns the source files to build.
+	std::vector<std::filesystem::path> GenerateProgramFiles(const std::filesystem::path& directory, size_t fileCount, size_t unitySize = 1) const;
+
+	// Converts the symbols of the built program to a perf map, /tmp/perf-<pid>.map, that names the generated functions
+	// and their template instantiations by the qualified lovela names of the functions, so that perf reports show them.
+	// The symbols are the output of `nm --defined-only --print-size --demangle <program>`.
+	// The load address of the program is added to the symbol addresses, for position independent executables.
+	static void GeneratePerfMap(std::istream& symbols, std::ostream& perfMap, const std::vector<Node>& nodes, uint64_t loadAddress = 0);
+
+	// The C++ name of the type, and the C name used in export and import declarations.
+	// The coder caches the names of interned types.
+	[[nodiscard]] static std::string GetTypeName(const TypeSpec& type);
+	[[nodiscard]] static std::string GetExportTypeName(const TypeSpec& type);
+
 private:
 	struct Context
 	{
 		size_t variableIndex{};
 		bool inner{};
+		// Set if the previous local is used once by the current operation, and can be moved.
+		bool moveInput{};
+		// The operations whose values are the input of the current operation, and are nested in it instead of assigned to locals.
+		std::span<Node> fused;
+		// The call of the function to itself at the end of its body, which is generated as the next iteration of a loop,
+		// and the parameters that it assigns.
+		const Node* tailCall{};
+		std::span<const std::pair<std::string, std::string>> tailParameters;
+		// The loop variables that are copied from parameters that aren't passed by value.
+		std::vector<std::pair<std::string, std::string>> tailCopies;
+		// The locals of the results of the calls that may fail, see Options::results, and how the function passes on their errors.
+		size_t resultIndex{};
+		std::unordered_map<const Node*, size_t> results;
+		enum class Failure { Throw, Return, Main } failure{};
+	};
+
+	// A consecutive part of the generated code, with the functions that it defines.
+	struct Definition
+	{
+		size_t size{};
+		// The declarations of the defined functions.
+		std::vector<std::string> declarations;
+		// Set if the code must be in the shared header of a split program.
+		bool shared{};
+		// The calls of the defined functions in Options::profileUse.
+		uint64_t calls{};
 	};
 
+	struct InputUses
+	{
+		// References to the input of the operation.
+		size_t inputs{};
+		// References to the input that are the input of a function call.
+		size_t arguments{};
+		// Function calls in the operation, including the operation itself.
+		size_t calls{};
+	};
+
+	[[nodiscard]] std::string GetRuntimeInclude() const;
+	void LineDirective(const Node& node);
+	void ProfilerScope(const Node& node);
+
+	void CodeNode(Node& node);
+	virtual std::string FindImplementation(const Node& node);
+	void CodeParallel();
+	void CodeCached(Node& node);
+	void GenerateNode(Node& node);
+	void BeginDefinition();
+	void EndDefinition();
 	void Visit(Context& context, Node& node);
 
 	void Visit(Context& context, std::vector<Node>& nodes)
@@ -56,29 +188,27 @@ private:
 			Visit(context, nodes[i]);
 	}
 
-	[[nodiscard]] constexpr OutputT& Cursor() noexcept
+	[[nodiscard]] constexpr CodeWriter& Cursor() noexcept
 	{
-		return *streamPtr;
+		return writer;
 	}
 
-	[[nodiscard]] OutputT& Scope() noexcept
+	[[nodiscard]] CodeWriter& Scope()
 	{
-		*streamPtr << '\n';
-		for (size_t i = 0; i < indent; ++i)
-			*streamPtr << ' ' << ' ';
-		return *streamPtr;
+		return writer.NewLine(indent);
 	}
 
-	OutputT& NewLine() noexcept
+	CodeWriter& NewLine()
 	{
-		*streamPtr << '\n';
-		return *streamPtr;
+		return writer.NewLine();
 	}
 
 	void FunctionDeclarationVisitor(Node& node, Context& context);
 	void ExpressionVisitor(Node& node, Context& context);
 	void ExpressionInputVisitor(Node& node, Context& context);
 	void FunctionCallVisitor(Node& node, Context& context);
+	void CallExpression(Node& node, Context& context);
+	size_t AssignResult(Node& call, Context& context);
 	void BinaryOperationVisitor(Node& node, Context& context);
 	void LiteralVisitor(Node& node, Context& context);
 	void TupleVisitor(Node& node, Context& context);
@@ -89,6 +219,8 @@ private:
 	void ExportedFunctionDeclaration(Node& node, Context& context);
 	void ImportedFunctionDeclaration(Node& node, Context& context);
 	void FunctionBody(Node& node, Context& context);
+	void TailCall(Node& node, Context& context);
+	void ForwardingBody(Node& node, const std::vector<std::string>& templateParameters, const std::vector<std::pair<std::string, std::string>>& parameters);
 	void ImportedFunctionBody(Node& node, Context& context, const std::vector<std::pair<std::string, std::string>>& parameters);
 
 	void BeginScope();
@@ -100,28 +232,49 @@ private:
 
 	std::string ConvertTypeName(const TypeSpec& type);
 	TypeSpec ConvertType(const TypeSpec& type);
+	static std::string FormatSignature(std::string_view outType, std::string_view name, const std::vector<std::pair<std::string, std::string>>& parameters);
+	static std::string ParameterTypeName(const TypeSpec& type, const std::string& name);
+	static std::string CopiedParameterName(const std::string& name);
 	static std::string ParameterName(const std::string& name);
 	static std::string ParameterName(const std::string& name, size_t index);
 	static std::string FunctionName(const std::string& name);
+	static InputUses GetInputUses(Node& operation);
+	static const Node* GetTailCall(const Node& function);
+	static bool TakesContext(const Node& function);
+	[[nodiscard]] bool ReturnsResult(const Node& function) const;
+	[[nodiscard]] bool CatchesErrors(const Node& call) const;
+	[[nodiscard]] bool MayFail(const Node& call) const;
+	static std::string MoveInput(size_t index);
 	static std::string RefVar(char prefix, size_t index);
 
 	std::optional<TypeSpec> CheckExportType(const TypeSpec& type);
 	std::optional<std::string> ConvertPrimitiveType(const TypeSpec& type);
-
-	using Visitor = std::function<void(CoderCpp*, Node&, Context&)>;
-	static std::map<Node::Type, Visitor>& GetVisitors();
-	static std::map<Node::Type, Visitor>& GetInternalVisitors();
+	static const std::string& GetCachedName(std::vector<std::string>& names, const TypeSpec& type, std::string (*getName)(const TypeSpec&));
 
 	static const TypeSpec& GetVoidType();
 	static const TypeSpec& GetVoidPtrType();
 
 	OutputT* streamPtr{};
+	CodeWriter writer;
 	size_t indent{};
 	std::vector<std::string> errors;
 	std::vector<std::string> headers;
 	std::vector<std::string> exports;
+	std::vector<Definition> definitions;
+	size_t definitionStart{};
+	// The first function with each normalized code, see FindImplementation.
+	std::unordered_map<std::string, std::string> implementations;
+	// The earlier function with the same code as the current top-level declaration, if Options::deduplicate is set.
+	std::string implementation;
+	// The C++ and export names of the interned types, by id.
+	std::vector<std::string> typeNames;
+	std::vector<std::string> exportTypeNames;
 
 	static constexpr char LocalVar{ 'v' };
+	static constexpr char ResultVar{ 'r' };
+
+	// Values of at most this number of bytes are passed by value, and larger values by reference.
+	static constexpr size_t MaxValueSize{ 16 };
 
 	struct TypeNames
 	{
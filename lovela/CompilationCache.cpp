@@ -0,0 +1,49 @@
+#include "pch.h"
+#include "CompilationCache.h"
+
+CompilationCache::CompilationCache(std::filesystem::path directory)
+	: directory(std::move(directory))
+{
+	std::error_code error;
+	std::filesystem::create_directories(this->directory, error);
+}
+
+std::optional<std::string> CompilationCache::Load(std::string_view kind, uint64_t key) const
+{
+	std::ifstream file(GetPath(kind, key), std::ios::binary);
+	if (!file)
+		return {};
+
+	std::ostringstream data;
+	data << file.rdbuf();
+	if (file.bad())
+		return {};
+
+	return data.str();
+}
+
+void CompilationCache::Store(std::string_view kind, uint64_t key, std::string_view data) const
+{
+	const auto path = GetPath(kind, key);
+
+	// Write to a temporary file first, so that concurrent compiler runs never read a partially written entry.
+	// The temporary file is unique per thread, since parallel code generation may store the same entry twice.
+	auto temporaryPath = path;
+	temporaryPath += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file.write(data.data(), data.size()))
+			return;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error)
+		std::filesystem::remove(temporaryPath, error);
+}
+
+std::filesystem::path CompilationCache::GetPath(std::string_view kind, uint64_t key) const
+{
+	return directory / fmt::format("{:016x}.{}", key, kind);
+}
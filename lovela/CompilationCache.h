@@ -0,0 +1,66 @@
+#pragma once
+
+// On-disk cache for the results of compiling individual top-level declarations.
+// Entries are content addressed: the key is a hash of the input that the result is derived from,
+// so unchanged declarations are reused across compiler runs and changed ones are simply not found.
+class CompilationCache
+{
+public:
+	// Bump the version whenever the parser or coder output changes, to invalidate old cache entries.
+	static constexpr uint64_t Version = 9;
+
+	// 64 bit FNV-1a hash, seeded with the cache version.
+	class Hasher
+	{
+	public:
+		Hasher() noexcept
+		{
+			Add(Version);
+		}
+
+		Hasher& Add(uint64_t value) noexcept
+		{
+			for (size_t i = 0; i < sizeof(value); ++i, value >>= 8)
+				AddByte(static_cast<uint8_t>(value));
+
+			return *this;
+		}
+
+		Hasher& Add(std::string_view value) noexcept
+		{
+			// The length separates consecutive strings, so that "ab" + "c" and "a" + "bc" hash differently.
+			Add(value.size());
+
+			for (auto c : value)
+				AddByte(static_cast<uint8_t>(c));
+
+			return *this;
+		}
+
+		[[nodiscard]] constexpr uint64_t Get() const noexcept
+		{
+			return hash;
+		}
+
+	private:
+		constexpr void AddByte(uint8_t byte) noexcept
+		{
+			hash = (hash ^ byte) * 0x100000001b3;
+		}
+
+		uint64_t hash = 0xcbf29ce484222325;
+	};
+
+	CompilationCache(std::filesystem::path directory);
+
+	// Returns the cached data of the given kind, if any.
+	[[nodiscard]] std::optional<std::string> Load(std::string_view kind, uint64_t key) const;
+
+	// Stores the data of the given kind. Failures are ignored, since the cache is only an optimization.
+	void Store(std::string_view kind, uint64_t key, std::string_view data) const;
+
+private:
+	[[nodiscard]] std::filesystem::path GetPath(std::string_view kind, uint64_t key) const;
+
+	std::filesystem::path directory;
+};
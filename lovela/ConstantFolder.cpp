@@ -0,0 +1,401 @@
+#include "pch.h"
+#include "ConstantFolder.h"
+#include "Parser.h"
+#include "TypeTable.h"
+
+namespace
+{
+	// The math functions that IEEE 754 requires to be exact or correctly rounded,
+	// so that they give the same result at compile time as in any C runtime library.
+	const std::map<std::string_view, double(*)(double)>& GetUnaryMathFunctions()
+	{
+		static const std::map<std::string_view, double(*)(double)> functions
+		{
+			{ "ceil", [](double x) { return std::ceil(x); } },
+			{ "fabs", [](double x) { return std::fabs(x); } },
+			{ "floor", [](double x) { return std::floor(x); } },
+			{ "sqrt", [](double x) { return std::sqrt(x); } },
+		};
+
+		return functions;
+	}
+
+	const std::map<std::string_view, double(*)(double, double)>& GetBinaryMathFunctions()
+	{
+		static const std::map<std::string_view, double(*)(double, double)> functions
+		{
+			{ "fmod", [](double x, double y) { return std::fmod(x, y); } },
+		};
+
+		return functions;
+	}
+
+	template <typename T>
+	std::optional<T> Add(T a, T b) noexcept
+	{
+		using Limits = std::numeric_limits<T>;
+
+		if constexpr (std::is_signed_v<T>)
+		{
+			if ((b > 0 && a > Limits::max() - b) || (b < 0 && a < Limits::min() - b))
+				return {};
+		}
+
+		// Unsigned arithmetic wraps around, also at run time.
+		return static_cast<T>(a + b);
+	}
+
+	template <typename T>
+	std::optional<T> Subtract(T a, T b) noexcept
+	{
+		using Limits = std::numeric_limits<T>;
+
+		if constexpr (std::is_signed_v<T>)
+		{
+			if ((b < 0 && a > Limits::max() + b) || (b > 0 && a < Limits::min() + b))
+				return {};
+		}
+
+		return static_cast<T>(a - b);
+	}
+
+	template <typename T>
+	std::optional<T> Multiply(T a, T b) noexcept
+	{
+		if constexpr (std::is_signed_v<T>)
+		{
+			using Unsigned = std::make_unsigned_t<T>;
+
+			if (!a || !b)
+				return T{};
+
+			if (a == -1 || b == -1)
+			{
+				const auto other = a == -1 ? b : a;
+				if (other == std::numeric_limits<T>::min())
+					return {};
+
+				return static_cast<T>(-other);
+			}
+
+			// The wrapped product only divides back to the operand if it didn't overflow.
+			const auto product = static_cast<T>(static_cast<Unsigned>(a) * static_cast<Unsigned>(b));
+			if (product / b != a)
+				return {};
+
+			return product;
+		}
+		else
+		{
+			return static_cast<T>(a * b);
+		}
+	}
+
+	template <typename T>
+	std::optional<T> Divide(T a, T b) noexcept
+	{
+		if (!b)
+			return {};
+
+		if constexpr (std::is_signed_v<T>)
+		{
+			if (a == std::numeric_limits<T>::min() && b == -1)
+				return {};
+		}
+
+		return static_cast<T>(a / b);
+	}
+
+	template <typename T>
+	std::optional<T> Apply(std::string_view operation, T a, T b) noexcept
+	{
+		if constexpr (std::is_floating_point_v<T>)
+		{
+			T result{};
+
+			if (operation == "+")
+				result = a + b;
+			else if (operation == "-")
+				result = a - b;
+			else if (operation == "*")
+				result = a * b;
+			else if (operation == "/" && b != 0)
+				result = a / b;
+			else
+				return {};
+
+			// Infinity and NaN have no literals.
+			if (!std::isfinite(result))
+				return {};
+
+			return result;
+		}
+		else
+		{
+			if (operation == "+")
+				return Add(a, b);
+			else if (operation == "-")
+				return Subtract(a, b);
+			else if (operation == "*")
+				return Multiply(a, b);
+			else if (operation == "/")
+				return Divide(a, b);
+			else
+				return {};
+		}
+	}
+
+	bool IsDoubleOrAny(const TypeSpec& type)
+	{
+		return type.Is(TypeSpec::Kind::Any)
+			|| (type.Is(TypeSpec::Kind::Primitive) && type.arrayDims.empty() && type.primitive.floatType && type.primitive.bits == 64);
+	}
+}
+
+ConstantFolder::ConstantFolder(Resolver resolver)
+	: resolver(std::move(resolver))
+{
+}
+
+size_t ConstantFolder::Fold(Node& node) const
+{
+	// Fold the operands first, so that grouped expressions become literals.
+	size_t count = 0;
+	for (auto& child : node.children)
+		count += Fold(child);
+
+	if (node.type != Node::Type::Expression)
+		return count;
+
+	const auto operations = node.children.size();
+	if (!FoldExpression(node))
+		return count;
+
+	// The expression is replaced by the literal if all operations were folded.
+	return count + operations - (node.type == Node::Type::Expression ? node.children.size() : 0);
+}
+
+bool ConstantFolder::FoldExpression(Node& node) const
+{
+	// Each operation takes the output of the previous one as input, so fold operations from the start while the input is constant.
+	std::optional<Node> folded;
+	size_t count = 0;
+
+	for (auto& operation : node.children)
+	{
+		auto result = FoldOperation(operation, folded.has_value() ? folded.value() : operation.children.front());
+		if (!result.has_value())
+			break;
+
+		folded = std::move(result);
+		++count;
+	}
+
+	if (!folded.has_value())
+		return false;
+
+	if (count == node.children.size())
+	{
+		node = std::move(folded.value());
+	}
+	else
+	{
+		// The input of the next operation is the folded value, also where its arguments and groups refer to it.
+		node.children.erase(node.children.begin(), node.children.begin() + count);
+		Traverse<Node>::DepthFirstPreorder(node.children.front(), [&](Node& n)
+			{
+				if (n.type == Node::Type::ExpressionInput)
+					n = folded.value();
+			});
+	}
+
+	return true;
+}
+
+std::optional<Node> ConstantFolder::FoldOperation(const Node& operation, const Node& input) const
+{
+	if (operation.children.empty())
+		return {};
+
+	switch (operation.type)
+	{
+	case Node::Type::BinaryOperation:
+	{
+		if (operation.token.type != Token::Type::OperatorArithmetic || operation.children.size() != 2)
+			return {};
+
+		const auto left = Evaluate(input);
+		const auto right = Evaluate(operation.children.back());
+		if (!left.has_value() || !right.has_value())
+			return {};
+
+		const auto result = Apply(operation.value, left.value(), right.value());
+		if (!result.has_value())
+			return {};
+
+		return ToLiteral(result.value(), operation.token);
+	}
+
+	case Node::Type::FunctionCall:
+		return FoldFunctionCall(operation, input);
+
+	default:
+		return {};
+	}
+}
+
+std::optional<Node> ConstantFolder::FoldFunctionCall(const Node& call, const Node& input) const
+{
+	const auto callee = call.callee ? call.callee.get() : resolver ? resolver(call) : nullptr;
+	if (!callee || !callee->apiSpec.Is(ApiSpec::Import | ApiSpec::Standard | ApiSpec::C))
+		return {};
+
+	// The generated function passes the values on as doubles, and returns a double.
+	if (!IsDoubleOrAny(callee->inType) || !IsDoubleOrAny(callee->outType))
+		return {};
+
+	for (auto& parameter : callee->parameters)
+	{
+		if (!IsDoubleOrAny(parameter->type))
+			return {};
+	}
+
+	std::vector<const Node*> arguments{ &input };
+	if (call.children.size() > 1)
+	{
+		auto& group = call.children[1];
+
+		if (group.type == Node::Type::Tuple)
+		{
+			for (auto& element : group.children)
+				arguments.push_back(&element);
+		}
+		else if (group.type != Node::Type::Empty)
+		{
+			arguments.push_back(&group);
+		}
+	}
+
+	if (arguments.size() != callee->parameters.size() + 1)
+		return {};
+
+	// The C++ math functions have overloads for float and long double, so only fold double arguments.
+	std::vector<double> values;
+	for (auto argument : arguments)
+	{
+		const auto value = Evaluate(*argument);
+		if (!value.has_value() || !std::holds_alternative<double>(value.value()))
+			return {};
+
+		values.push_back(std::get<double>(value.value()));
+	}
+
+	double result{};
+
+	auto& unaryFunctions = GetUnaryMathFunctions();
+	auto& binaryFunctions = GetBinaryMathFunctions();
+
+	if (const auto unary = unaryFunctions.find(callee->name); unary != unaryFunctions.end() && values.size() == 1)
+		result = unary->second(values[0]);
+	else if (const auto binary = binaryFunctions.find(callee->name); binary != binaryFunctions.end() && values.size() == 2)
+		result = binary->second(values[0], values[1]);
+	else
+		return {};
+
+	if (!std::isfinite(result))
+		return {};
+
+	return ToLiteral(result, call.token);
+}
+
+std::optional<ConstantFolder::Constant> ConstantFolder::Evaluate(const Node& node)
+{
+	if (node.type != Node::Type::Literal || node.value.empty())
+		return {};
+
+	std::string_view value = node.value;
+
+	if (node.token.type == Token::Type::LiteralDecimal)
+	{
+		// std::from_chars doesn't accept a leading plus sign.
+		if (value.front() == '+')
+			value.remove_prefix(1);
+
+		double d{};
+		const auto [ptr, error] = std::from_chars(value.data(), value.data() + value.size(), d);
+		if (error != std::errc{} || ptr != value.data() + value.size())
+			return {};
+
+		return d;
+	}
+	else if (node.token.type == Token::Type::LiteralInteger)
+	{
+		// A sign is a unary operator in C++, so the type is given by the digits alone.
+		const bool negative = value.front() == '-';
+		if (value.front() == '-' || value.front() == '+')
+			value.remove_prefix(1);
+
+		uint64_t u{};
+		const auto [ptr, error] = std::from_chars(value.data(), value.data() + value.size(), u);
+		if (error != std::errc{} || ptr != value.data() + value.size())
+			return {};
+
+		if (u <= static_cast<uint64_t>(std::numeric_limits<int32_t>::max()))
+			return negative ? -static_cast<int32_t>(u) : static_cast<int32_t>(u);
+		else if (u <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+			return negative ? -static_cast<int64_t>(u) : static_cast<int64_t>(u);
+		else
+			return negative ? 0 - u : u;
+	}
+
+	return {};
+}
+
+std::optional<ConstantFolder::Constant> ConstantFolder::Apply(std::string_view operation, const Constant& left, const Constant& right)
+{
+	return std::visit([operation](auto a, auto b) -> std::optional<Constant>
+		{
+			// The usual arithmetic conversions of C++.
+			using T = std::common_type_t<decltype(a), decltype(b)>;
+
+			if (const auto result = ::Apply(operation, static_cast<T>(a), static_cast<T>(b)))
+				return result.value();
+
+			return {};
+		}, left, right);
+}
+
+std::optional<Node> ConstantFolder::ToLiteral(const Constant& value, const Token& token)
+{
+	std::string text;
+	Token::Type type{};
+
+	if (std::holds_alternative<double>(value))
+	{
+		text = fmt::format("{}", std::get<double>(value));
+		type = Token::Type::LiteralDecimal;
+
+		// A decimal literal requires a fraction, which the shortest representation may leave out.
+		if (text.find('.') == std::string::npos)
+			text.insert(std::min(text.find_first_of("eE"), text.size()), ".0");
+	}
+	else
+	{
+		text = std::visit([](auto v) { return fmt::format("{}", v); }, value);
+		type = Token::Type::LiteralInteger;
+	}
+
+	Node node{ .type = Node::Type::Literal, .value = text, .token = token };
+	node.token.type = type;
+	node.token.value = text;
+
+	// The literal must have the same value and the same C++ type, since the type decides the type of later operations.
+	if (Evaluate(node) != value)
+		return {};
+
+	node.outType = TypeTable::Intern(type == Token::Type::LiteralDecimal
+		? Parser::GetPrimitiveDecimalTypeSpec(text)
+		: Parser::GetPrimitiveIntegerTypeSpec(text));
+
+	return node;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "Node.h"
+
+// Evaluates operations on literals at compile time and replaces them with the resulting literal:
+// arithmetic binary operations, and calls to the imported Standard C math functions whose results are exact.
+// An operation is only folded if the result is exactly what the generated C++ code computes at run time,
+// so operations that overflow, divide by zero, or give a literal of another C++ type are left as they are.
+class ConstantFolder
+{
+public:
+	// The C++ types of the literals in the generated code: int, long long, unsigned long long and double.
+	using Constant = std::variant<int32_t, int64_t, uint64_t, double>;
+
+	// Returns the declaration of the called function, if it's known.
+	using Resolver = std::function<const FunctionDeclaration*(const Node& call)>;
+
+	ConstantFolder(Resolver resolver = {});
+
+	// Folds the expressions in the node and its children. Returns the number of folded operations.
+	size_t Fold(Node& node) const;
+
+	// Returns the value of a number literal, with the type that C++ gives it.
+	[[nodiscard]] static std::optional<Constant> Evaluate(const Node& node);
+
+	// Returns the result of the arithmetic operation, unless it would overflow or divide by zero.
+	[[nodiscard]] static std::optional<Constant> Apply(std::string_view operation, const Constant& left, const Constant& right);
+
+	// Returns a literal with the value, if C++ gives the literal the same type as the value.
+	[[nodiscard]] static std::optional<Node> ToLiteral(const Constant& value, const Token& token);
+
+private:
+	[[nodiscard]] bool FoldExpression(Node& node) const;
+	[[nodiscard]] std::optional<Node> FoldOperation(const Node& operation, const Node& input) const;
+	[[nodiscard]] std::optional<Node> FoldFunctionCall(const Node& call, const Node& input) const;
+
+	Resolver resolver;
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+// The effects of calling a function, including the effects of the functions that it calls.
+// Functions without effects only compute their output from their input and arguments.
+struct Effects
+{
+	static constexpr int None = 0;
+	// Calls imported functions, which may do anything outside of the program.
+	static constexpr int Import = 1 << 0;
+	// Uses the streams, the error or the parameters of lovela::context, or calls functions that the program doesn't define, which may.
+	static constexpr int Context = 1 << 1;
+	static constexpr int Unknown = Import | Context;
+
+	// The effects are unknown until the analyzer has found them.
+	int flags = Unknown;
+
+	[[nodiscard]] constexpr auto operator<=>(const Effects& rhs) const noexcept = default;
+
+	constexpr void Set(int flag)
+	{
+		flags |= flag;
+	}
+
+	constexpr bool Is(int flag) const
+	{
+		return (flags & flag) == flag;
+	}
+
+	constexpr bool IsPure() const
+	{
+		return flags == None;
+	}
+};
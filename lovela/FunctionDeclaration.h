@@ -2,6 +2,7 @@
 #include "NameSpace.h"
 #include "TypeSpec.h"
 #include "ApiSpec.h"
+#include "Effects.h"
 #include "VariableDeclaration.h"
 
 using ParameterList = std::vector<std::shared_ptr<VariableDeclaration>>;
@@ -21,6 +22,12 @@ struct FunctionDeclaration
 	TypeSpec inType{};
 	ParameterList parameters{};
 	ApiSpec apiSpec{};
+	// Set by the analyzer.
+	Effects effects{};
+	// Set by the analyzer if calls of the function can be evaluated at compile time.
+	bool constant{};
+	// Set by the analyzer if the program defines the function, instead of only declaring it.
+	bool defined{};
 
 	[[nodiscard]] void Print(std::ostream& stream) const
 	{
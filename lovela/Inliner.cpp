@@ -0,0 +1,233 @@
+#include "pch.h"
+#include "Inliner.h"
+
+Inliner::Inliner(size_t maxSize, Resolver resolver, SizeLimit sizeLimit)
+	: maxSize(maxSize), resolver(std::move(resolver)), sizeLimit(std::move(sizeLimit))
+{
+}
+
+size_t Inliner::Inline(const std::vector<Node*>& definitions)
+{
+	for (auto definition : definitions)
+		functions[definition->callee.get()].definition = definition;
+
+	for (auto definition : definitions)
+	{
+		auto& function = functions.at(definition->callee.get());
+		if (function.state == State::Pending)
+			InlineFunction(function);
+	}
+
+	return count;
+}
+
+void Inliner::InlineFunction(Function& function)
+{
+	function.state = State::Inlining;
+
+	auto& body = function.definition->children.front();
+
+	// A callee that is still being inlined calls this function, directly or indirectly, so it's recursive and isn't inlined.
+	Traverse<Node>::DepthFirstPreorder(body, [this](Node& node)
+		{
+			if (node.type != Node::Type::FunctionCall)
+				return;
+
+			if (auto callee = GetFunction(node); callee && callee->state == State::Pending)
+				InlineFunction(*callee);
+		});
+
+	InlineCalls(body);
+
+	function.inlinable = IsInlinable(*function.definition);
+	function.state = State::Done;
+}
+
+void Inliner::InlineCalls(Node& node)
+{
+	for (auto& child : node.children)
+		InlineCalls(child);
+
+	if (node.type != Node::Type::Expression)
+		return;
+
+	auto& operations = node.children;
+
+	for (size_t i = 0; i < operations.size(); ++i)
+	{
+		if (operations[i].type != Node::Type::FunctionCall)
+			continue;
+
+		const auto callee = GetFunction(operations[i]);
+		if (!callee || callee->state != State::Done || !callee->inlinable)
+			continue;
+
+		auto inlined = Substitute(operations[i], *callee->definition);
+		if (!inlined.has_value())
+			continue;
+
+		auto& inlinedOperations = inlined.value();
+		operations.erase(operations.begin() + i);
+		operations.insert(operations.begin() + i, std::make_move_iterator(inlinedOperations.begin()), std::make_move_iterator(inlinedOperations.end()));
+		i += inlinedOperations.size() - 1;
+		++count;
+	}
+
+	// An inlined literal is the input of the next operation, as the parser makes it.
+	for (size_t i = 0; i + 1 < operations.size();)
+	{
+		auto& next = operations[i + 1];
+
+		if (operations[i].type == Node::Type::Literal && !next.children.empty() && next.children.front().type == Node::Type::ExpressionInput)
+		{
+			next.children.front() = std::move(operations[i]);
+			operations.erase(operations.begin() + i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	if (operations.size() == 1 && operations.front().type == Node::Type::Literal)
+	{
+		auto literal = std::move(operations.front());
+		node = std::move(literal);
+	}
+}
+
+Inliner::Function* Inliner::GetFunction(const Node& call)
+{
+	const auto iter = functions.find(resolver(call));
+	return iter != functions.end() ? &iter->second : nullptr;
+}
+
+bool Inliner::IsInlinable(const Node& definition) const
+{
+	// Main has no callers.
+	if (definition.value.empty())
+		return false;
+
+	if (!definition.inType.Is(TypeSpec::Kind::Any) || !definition.outType.Is(TypeSpec::Kind::Any))
+		return false;
+
+	for (auto& parameter : definition.parameters)
+	{
+		if (!parameter->type.Is(TypeSpec::Kind::Any))
+			return false;
+	}
+
+	const auto& body = definition.children.front();
+	size_t size = 0;
+	bool valid = true;
+
+	Traverse<const Node>::DepthFirstPreorder(body, [&](const Node& node)
+		{
+			++size;
+
+			// Calls to the function itself would make the function recursive once inlined into it.
+			if (node.type == Node::Type::FunctionCall && resolver(node) == definition.callee.get())
+				valid = false;
+		});
+
+	if (!valid || size > (sizeLimit ? sizeLimit(definition) : maxSize))
+		return false;
+
+	switch (body.type)
+	{
+	case Node::Type::Literal:
+	case Node::Type::VariableReference:
+		return true;
+
+	case Node::Type::Expression:
+		for (auto& operation : body.children)
+		{
+			if ((operation.type != Node::Type::BinaryOperation && operation.type != Node::Type::FunctionCall) || operation.children.empty())
+				return false;
+
+			// The input of the operations at the head of the chain is the only input that refers to the function input or the previous operation.
+			for (size_t i = 0; i < operation.children.size(); ++i)
+			{
+				if (i == 0 && operation.children[i].type == Node::Type::ExpressionInput)
+					continue;
+
+				Traverse<const Node>::DepthFirstPreorder(operation.children[i], [&](const Node& node)
+					{
+						if (node.type == Node::Type::ExpressionInput)
+							valid = false;
+					});
+			}
+		}
+
+		return valid;
+
+	default:
+		return false;
+	}
+}
+
+std::optional<std::vector<Node>> Inliner::Substitute(const Node& call, const Node& definition)
+{
+	std::vector<const Node*> arguments;
+
+	if (call.children.size() > 1)
+	{
+		auto& group = call.children[1];
+
+		if (group.type == Node::Type::Tuple)
+		{
+			for (auto& element : group.children)
+				arguments.push_back(&element);
+		}
+		else if (group.type != Node::Type::Empty)
+		{
+			arguments.push_back(&group);
+		}
+	}
+
+	if (arguments.size() != definition.parameters.size())
+		return {};
+
+	// Arguments are copied to each use of the parameter, so they must be cheap and without side effects.
+	for (auto argument : arguments)
+	{
+		if (argument->type != Node::Type::Literal && argument->type != Node::Type::VariableReference)
+			return {};
+	}
+
+	auto body = definition.children.front();
+
+	Traverse<Node>::DepthFirstPreorder(body, [&](Node& node)
+		{
+			if (node.type != Node::Type::VariableReference)
+				return;
+
+			for (size_t i = 0; i < arguments.size(); ++i)
+			{
+				if (definition.parameters[i]->name == node.value)
+				{
+					node = *arguments[i];
+					break;
+				}
+			}
+		});
+
+	switch (body.type)
+	{
+	case Node::Type::Literal:
+		return std::vector<Node>{ std::move(body) };
+
+	case Node::Type::Expression:
+	{
+		auto& input = body.children.front().children.front();
+		if (input.type == Node::Type::ExpressionInput)
+			input = call.children.front();
+
+		return std::move(body.children);
+	}
+
+	default:
+		// A variable reference isn't an operation.
+		return {};
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "Node.h"
+
+// Replaces calls to small functions with the bodies of the functions, so that chains of tiny functions
+// don't depend on the C++ compiler to inline across function templates.
+// The input of the inlined body is the input of the call, and its parameters are replaced by the arguments of the call.
+// Only functions without declared types are inlined, since a declared type converts the values at the call.
+// Recursive functions aren't inlined, and callees are inlined into their own callers first,
+// so that the size limit applies to the final bodies.
+class Inliner
+{
+public:
+	// Returns the declaration of the called function, if it's known.
+	using Resolver = std::function<const FunctionDeclaration*(const Node& call)>;
+
+	// Returns the largest number of nodes in the body of the function for it to be inlined.
+	using SizeLimit = std::function<size_t(const Node& definition)>;
+
+	// Functions with at most the given number of nodes in their bodies are inlined,
+	// or at most the size limit of each function, if it's set.
+	Inliner(size_t maxSize, Resolver resolver, SizeLimit sizeLimit = {});
+
+	// Inlines the calls in the function definitions. Returns the number of inlined calls.
+	size_t Inline(const std::vector<Node*>& definitions);
+
+private:
+	enum class State
+	{
+		Pending,
+		Inlining,
+		Done,
+	};
+
+	struct Function
+	{
+		Node* definition{};
+		State state{};
+		bool inlinable{};
+	};
+
+	void InlineFunction(Function& function);
+	void InlineCalls(Node& node);
+	[[nodiscard]] Function* GetFunction(const Node& call);
+	[[nodiscard]] bool IsInlinable(const Node& definition) const;
+	[[nodiscard]] static std::optional<std::vector<Node>> Substitute(const Node& call, const Node& definition);
+
+	size_t maxSize{};
+	Resolver resolver;
+	SizeLimit sizeLimit;
+	std::unordered_map<const FunctionDeclaration*, Function> functions;
+	size_t count{};
+};
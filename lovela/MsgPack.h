@@ -0,0 +1,310 @@
+#pragma once
+
+// Minimal MessagePack (https://msgpack.org/) writer and reader for the subset used by the compiler:
+// nil, bool, integers, strings and arrays.
+
+struct MsgPackException : public std::runtime_error
+{
+	MsgPackException() noexcept
+		: std::runtime_error("Malformed MessagePack data.")
+	{
+	}
+};
+
+class MsgPackWriter
+{
+public:
+	MsgPackWriter(std::string& buffer) noexcept
+		: buffer(buffer)
+	{
+	}
+
+	void WriteNil()
+	{
+		Put(0xc0);
+	}
+
+	void WriteBool(bool value)
+	{
+		Put(value ? 0xc3 : 0xc2);
+	}
+
+	void WriteUInt(uint64_t value)
+	{
+		if (value < 0x80)
+		{
+			Put(static_cast<uint8_t>(value));
+		}
+		else if (value <= std::numeric_limits<uint8_t>::max())
+		{
+			Put(0xcc);
+			Put(static_cast<uint8_t>(value));
+		}
+		else if (value <= std::numeric_limits<uint16_t>::max())
+		{
+			Put(0xcd);
+			PutBigEndian(static_cast<uint16_t>(value));
+		}
+		else if (value <= std::numeric_limits<uint32_t>::max())
+		{
+			Put(0xce);
+			PutBigEndian(static_cast<uint32_t>(value));
+		}
+		else
+		{
+			Put(0xcf);
+			PutBigEndian(value);
+		}
+	}
+
+	void WriteInt(int64_t value)
+	{
+		if (value >= 0)
+		{
+			WriteUInt(static_cast<uint64_t>(value));
+		}
+		else if (value >= -32)
+		{
+			Put(static_cast<uint8_t>(value));
+		}
+		else if (value >= std::numeric_limits<int8_t>::min())
+		{
+			Put(0xd0);
+			Put(static_cast<uint8_t>(value));
+		}
+		else if (value >= std::numeric_limits<int16_t>::min())
+		{
+			Put(0xd1);
+			PutBigEndian(static_cast<uint16_t>(value));
+		}
+		else if (value >= std::numeric_limits<int32_t>::min())
+		{
+			Put(0xd2);
+			PutBigEndian(static_cast<uint32_t>(value));
+		}
+		else
+		{
+			Put(0xd3);
+			PutBigEndian(static_cast<uint64_t>(value));
+		}
+	}
+
+	void WriteString(std::string_view value)
+	{
+		const auto size = value.size();
+
+		if (size < 32)
+		{
+			Put(static_cast<uint8_t>(0xa0 | size));
+		}
+		else if (size <= std::numeric_limits<uint8_t>::max())
+		{
+			Put(0xd9);
+			Put(static_cast<uint8_t>(size));
+		}
+		else if (size <= std::numeric_limits<uint16_t>::max())
+		{
+			Put(0xda);
+			PutBigEndian(static_cast<uint16_t>(size));
+		}
+		else
+		{
+			Put(0xdb);
+			PutBigEndian(static_cast<uint32_t>(size));
+		}
+
+		buffer.append(value);
+	}
+
+	void WriteArray(size_t size)
+	{
+		if (size < 16)
+		{
+			Put(static_cast<uint8_t>(0x90 | size));
+		}
+		else if (size <= std::numeric_limits<uint16_t>::max())
+		{
+			Put(0xdc);
+			PutBigEndian(static_cast<uint16_t>(size));
+		}
+		else
+		{
+			Put(0xdd);
+			PutBigEndian(static_cast<uint32_t>(size));
+		}
+	}
+
+	void WriteStringArray(const std::vector<std::string>& values)
+	{
+		WriteArray(values.size());
+
+		for (auto& value : values)
+			WriteString(value);
+	}
+
+private:
+	void Put(uint8_t byte)
+	{
+		buffer.push_back(static_cast<char>(byte));
+	}
+
+	template <typename T>
+	void PutBigEndian(T value)
+	{
+		for (int shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8)
+			Put(static_cast<uint8_t>(value >> shift));
+	}
+
+	std::string& buffer;
+};
+
+// Reads the values written by MsgPackWriter.
+// Throws MsgPackException if the data is truncated or if a value isn't of the expected type.
+class MsgPackReader
+{
+public:
+	MsgPackReader(std::string_view buffer) noexcept
+		: buffer(buffer)
+	{
+	}
+
+	[[nodiscard]] bool IsDone() const noexcept
+	{
+		return buffer.empty();
+	}
+
+	[[nodiscard]] bool ReadNil()
+	{
+		if (Peek() != 0xc0)
+			return false;
+
+		Get();
+		return true;
+	}
+
+	[[nodiscard]] bool ReadBool()
+	{
+		switch (Get())
+		{
+		case 0xc2: return false;
+		case 0xc3: return true;
+		default: throw MsgPackException();
+		}
+	}
+
+	[[nodiscard]] uint64_t ReadUInt()
+	{
+		const auto byte = Get();
+
+		if (byte < 0x80)
+			return byte;
+
+		switch (byte)
+		{
+		case 0xcc: return Get();
+		case 0xcd: return GetBigEndian<uint16_t>();
+		case 0xce: return GetBigEndian<uint32_t>();
+		case 0xcf: return GetBigEndian<uint64_t>();
+		default: throw MsgPackException();
+		}
+	}
+
+	[[nodiscard]] int64_t ReadInt()
+	{
+		const auto byte = Peek();
+
+		if (byte < 0x80 || (byte >= 0xcc && byte <= 0xcf))
+			return static_cast<int64_t>(ReadUInt());
+
+		Get();
+
+		if (byte >= 0xe0)
+			return static_cast<int8_t>(byte);
+
+		switch (byte)
+		{
+		case 0xd0: return static_cast<int8_t>(Get());
+		case 0xd1: return static_cast<int16_t>(GetBigEndian<uint16_t>());
+		case 0xd2: return static_cast<int32_t>(GetBigEndian<uint32_t>());
+		case 0xd3: return static_cast<int64_t>(GetBigEndian<uint64_t>());
+		default: throw MsgPackException();
+		}
+	}
+
+	[[nodiscard]] std::string_view ReadString()
+	{
+		const auto byte = Get();
+		size_t size{};
+
+		if ((byte & 0xe0) == 0xa0)
+			size = byte & 0x1f;
+		else if (byte == 0xd9)
+			size = Get();
+		else if (byte == 0xda)
+			size = GetBigEndian<uint16_t>();
+		else if (byte == 0xdb)
+			size = GetBigEndian<uint32_t>();
+		else
+			throw MsgPackException();
+
+		if (size > buffer.size())
+			throw MsgPackException();
+
+		const auto value = buffer.substr(0, size);
+		buffer.remove_prefix(size);
+		return value;
+	}
+
+	[[nodiscard]] size_t ReadArray()
+	{
+		const auto byte = Get();
+
+		if ((byte & 0xf0) == 0x90)
+			return byte & 0x0f;
+		else if (byte == 0xdc)
+			return GetBigEndian<uint16_t>();
+		else if (byte == 0xdd)
+			return GetBigEndian<uint32_t>();
+		else
+			throw MsgPackException();
+	}
+
+	[[nodiscard]] std::vector<std::string> ReadStringArray()
+	{
+		std::vector<std::string> values(ReadArray());
+
+		for (auto& value : values)
+			value = ReadString();
+
+		return values;
+	}
+
+private:
+	[[nodiscard]] uint8_t Peek() const
+	{
+		if (buffer.empty())
+			throw MsgPackException();
+
+		return static_cast<uint8_t>(buffer.front());
+	}
+
+	uint8_t Get()
+	{
+		const auto byte = Peek();
+		buffer.remove_prefix(1);
+		return byte;
+	}
+
+	template <typename T>
+	[[nodiscard]] T GetBigEndian()
+	{
+		T value{};
+
+		for (size_t i = 0; i < sizeof(T); ++i)
+			value = static_cast<T>((value << 8) | Get());
+
+		return value;
+	}
+
+	std::string_view buffer;
+};
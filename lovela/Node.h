@@ -34,7 +34,8 @@ struct Node
 	ParameterList parameters{};
 	ApiSpec apiSpec{};
 
-	// Function call
+	// Function call: the called function, set by the analyzer.
+	// Function declaration: the declaration itself, shared with its calls.
 	std::shared_ptr<FunctionDeclaration> callee;
 
 	std::vector<Node> children;
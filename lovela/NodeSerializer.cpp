@@ -0,0 +1,163 @@
+#include "pch.h"
+#include "NodeSerializer.h"
+#include "TypeTable.h"
+
+void NodeSerializer::Serialize(MsgPackWriter& writer, const Node& node, size_t baseLine)
+{
+	writer.WriteArray(10);
+	writer.WriteUInt(static_cast<uint64_t>(node.type));
+	writer.WriteString(node.value);
+	Serialize(writer, node.outType);
+	Serialize(writer, node.token, baseLine);
+	Serialize(writer, node.nameSpace);
+	Serialize(writer, node.inType);
+
+	writer.WriteArray(node.parameters.size());
+	for (auto& parameter : node.parameters)
+	{
+		writer.WriteArray(2);
+		writer.WriteString(parameter->name);
+		Serialize(writer, parameter->type);
+	}
+
+	writer.WriteInt(node.apiSpec.flags);
+
+	writer.WriteArray(2);
+	writer.WriteUInt(static_cast<uint64_t>(node.error.code));
+	writer.WriteString(node.error.message);
+
+	Serialize(writer, node.children, baseLine);
+}
+
+void NodeSerializer::Serialize(MsgPackWriter& writer, const std::vector<Node>& nodes, size_t baseLine)
+{
+	writer.WriteArray(nodes.size());
+
+	for (auto& node : nodes)
+		Serialize(writer, node, baseLine);
+}
+
+void NodeSerializer::Serialize(MsgPackWriter& writer, const Token& token, size_t baseLine)
+{
+	writer.WriteArray(7);
+	writer.WriteUInt(static_cast<uint64_t>(token.type));
+	writer.WriteString(token.value);
+	writer.WriteUInt(static_cast<uint64_t>(token.error.code));
+	writer.WriteInt(static_cast<int64_t>(token.error.line) - static_cast<int64_t>(baseLine));
+	writer.WriteUInt(token.error.column);
+	writer.WriteUInt(token.error.length);
+	writer.WriteString(token.error.message);
+}
+
+void NodeSerializer::Serialize(MsgPackWriter& writer, const TypeSpec& type)
+{
+	writer.WriteArray(7);
+	writer.WriteUInt(static_cast<uint64_t>(type.kind));
+	writer.WriteString(type.name);
+	Serialize(writer, type.nameSpace);
+
+	writer.WriteArray(type.arrayDims.size());
+	for (auto& length : type.arrayDims)
+		writer.WriteUInt(length);
+
+	writer.WriteUInt(type.primitive.bits);
+	writer.WriteBool(type.primitive.signedType);
+	writer.WriteBool(type.primitive.floatType);
+}
+
+void NodeSerializer::Serialize(MsgPackWriter& writer, const NameSpace& nameSpace)
+{
+	writer.WriteArray(2);
+	writer.WriteStringArray(nameSpace.parts);
+	writer.WriteBool(nameSpace.root);
+}
+
+Node NodeSerializer::Deserialize(MsgPackReader& reader, size_t baseLine)
+{
+	if (reader.ReadArray() != 10)
+		throw MsgPackException();
+
+	Node node{ .type = ReadEnum<Node::Type>(reader) };
+	node.value = reader.ReadString();
+	node.outType = DeserializeTypeSpec(reader);
+	node.token = DeserializeToken(reader, baseLine);
+	node.nameSpace = DeserializeNameSpace(reader);
+	node.inType = DeserializeTypeSpec(reader);
+
+	node.parameters.resize(reader.ReadArray());
+	for (auto& parameter : node.parameters)
+	{
+		if (reader.ReadArray() != 2)
+			throw MsgPackException();
+
+		parameter = make<VariableDeclaration>::shared();
+		parameter->name = reader.ReadString();
+		parameter->type = DeserializeTypeSpec(reader);
+	}
+
+	node.apiSpec.flags = static_cast<int>(reader.ReadInt());
+
+	if (reader.ReadArray() != 2)
+		throw MsgPackException();
+
+	node.error.code = ReadEnum<Node::Error::Code>(reader);
+	node.error.message = reader.ReadString();
+
+	node.children = DeserializeNodes(reader, baseLine);
+
+	return node;
+}
+
+std::vector<Node> NodeSerializer::DeserializeNodes(MsgPackReader& reader, size_t baseLine)
+{
+	std::vector<Node> nodes(reader.ReadArray());
+
+	for (auto& node : nodes)
+		node = Deserialize(reader, baseLine);
+
+	return nodes;
+}
+
+Token NodeSerializer::DeserializeToken(MsgPackReader& reader, size_t baseLine)
+{
+	if (reader.ReadArray() != 7)
+		throw MsgPackException();
+
+	Token token{ .type = ReadEnum<Token::Type>(reader) };
+	token.value = reader.ReadString();
+	token.error.code = ReadEnum<Token::Error::Code>(reader);
+	token.error.line = static_cast<size_t>(static_cast<int64_t>(baseLine) + reader.ReadInt());
+	token.error.column = reader.ReadUInt();
+	token.error.length = reader.ReadUInt();
+	token.error.message = reader.ReadString();
+	return token;
+}
+
+TypeSpec NodeSerializer::DeserializeTypeSpec(MsgPackReader& reader)
+{
+	if (reader.ReadArray() != 7)
+		throw MsgPackException();
+
+	TypeSpec type{ .kind = ReadEnum<TypeSpec::Kind>(reader) };
+	type.name = reader.ReadString();
+	type.nameSpace = DeserializeNameSpace(reader);
+
+	type.arrayDims.resize(reader.ReadArray());
+	for (auto& length : type.arrayDims)
+		length = reader.ReadUInt();
+
+	type.primitive.bits = static_cast<unsigned char>(reader.ReadUInt());
+	type.primitive.signedType = reader.ReadBool();
+	type.primitive.floatType = reader.ReadBool();
+	return TypeTable::Intern(std::move(type));
+}
+
+NameSpace NodeSerializer::DeserializeNameSpace(MsgPackReader& reader)
+{
+	if (reader.ReadArray() != 2)
+		throw MsgPackException();
+
+	NameSpace nameSpace{ .parts = reader.ReadStringArray() };
+	nameSpace.root = reader.ReadBool();
+	return nameSpace;
+}
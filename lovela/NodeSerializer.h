@@ -0,0 +1,35 @@
+#pragma once
+#include "Node.h"
+#include "MsgPack.h"
+
+// Serializes syntax trees in a compact MessagePack representation.
+// Token line numbers are stored relative to a base line, so that a tree can be restored at a different line.
+class NodeSerializer
+{
+public:
+	static void Serialize(MsgPackWriter& writer, const Node& node, size_t baseLine);
+	static void Serialize(MsgPackWriter& writer, const std::vector<Node>& nodes, size_t baseLine);
+
+	// Throws MsgPackException if the data is malformed.
+	[[nodiscard]] static Node Deserialize(MsgPackReader& reader, size_t baseLine);
+	[[nodiscard]] static std::vector<Node> DeserializeNodes(MsgPackReader& reader, size_t baseLine);
+
+private:
+	static void Serialize(MsgPackWriter& writer, const Token& token, size_t baseLine);
+	static void Serialize(MsgPackWriter& writer, const TypeSpec& type);
+	static void Serialize(MsgPackWriter& writer, const NameSpace& nameSpace);
+
+	[[nodiscard]] static Token DeserializeToken(MsgPackReader& reader, size_t baseLine);
+	[[nodiscard]] static TypeSpec DeserializeTypeSpec(MsgPackReader& reader);
+	[[nodiscard]] static NameSpace DeserializeNameSpace(MsgPackReader& reader);
+
+	template <typename Enum>
+	[[nodiscard]] static Enum ReadEnum(MsgPackReader& reader)
+	{
+		const auto value = magic_enum::enum_cast<Enum>(static_cast<std::underlying_type_t<Enum>>(reader.ReadUInt()));
+		if (!value.has_value())
+			throw MsgPackException();
+
+		return value.value();
+	}
+};
@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "Parser.h"
 #include "ParseException.h"
+#include "NodeSerializer.h"
+#include "TypeTable.h"
 
 // Token sets
 
@@ -194,11 +196,19 @@ void Parser::Context::AddVariableSymbol(std::shared_ptr<VariableDeclaration> dec
 // Parser
 
 IParser::OutputT Parser::Parse() noexcept
+{
+	return options.cache ? ParseCachedDeclarations() : ParseDeclarations();
+}
+
+IParser::OutputT Parser::ParseDeclarations()
 {
 	currentContext = make<Context>::shared();
 
 	// TODO: add built-in functions?
 
+	// The number of parse errors since the last successfully parsed declaration.
+	size_t errors = 0;
+
 	bool parsing = true;
 
 	while (parsing)
@@ -216,6 +226,15 @@ IParser::OutputT Parser::Parse() noexcept
 			if (Accept(GetFunctionDeclarationTokens()))
 			{
 				Node n = ParseFunctionDeclaration(currentContext);
+
+				if (errors > options.maxErrorsPerDeclaration)
+				{
+					Node suppressed = GetSuppressedErrorsNode(errors);
+					co_yield suppressed;
+				}
+
+				errors = 0;
+
 				co_yield n;
 			}
 			else if (Accept(Token::Type::End))
@@ -223,7 +242,7 @@ IParser::OutputT Parser::Parse() noexcept
 				if (Peek())
 					throw UnexpectedTokenException(GetNext());
 				else
-					co_return;
+					parsing = false;
 			}
 			else if (Peek())
 			{
@@ -236,21 +255,167 @@ IParser::OutputT Parser::Parse() noexcept
 		}
 		catch (const MissingTokenException& e)
 		{
-			errorNode = { .type = Node::Type::Error, .error = {.code = Node::Error::Code::ParseError, .message = e.message } };
+			if (++errors <= options.maxErrorsPerDeclaration)
+				errorNode = { .type = Node::Type::Error, .token = e.token, .error = {.code = Node::Error::Code::ParseError, .message = e.message } };
 
 			// Stop parsing after yielding the error node.
 			parsing = false;
 		}
 		catch (const ParseException& e)
 		{
-			errorNode = { .type = Node::Type::Error, .error = {.code = Node::Error::Code::ParseError, .message = e.message } };
+			if (++errors <= options.maxErrorsPerDeclaration)
+				errorNode = { .type = Node::Type::Error, .token = e.token, .error = {.code = Node::Error::Code::ParseError, .message = e.message } };
 
-			// Skip faulty token.
-			Skip();
+			Synchronize();
 		}
 
 		if (errorNode) co_yield errorNode;
 	}
+
+	if (errors > options.maxErrorsPerDeclaration)
+	{
+		Node suppressed = GetSuppressedErrorsNode(errors);
+		co_yield suppressed;
+	}
+}
+
+IParser::OutputT Parser::ParseCachedDeclarations()
+{
+	// Top-level statements are parsed independently of each other,
+	// so each one is looked up in the cache by the hash of its tokens.
+	// Cache misses are parsed by a separate parser without cache.
+
+	std::vector<Token> statement;
+
+	while (!IsDone())
+	{
+		statement.clear();
+		ReadStatement(statement);
+
+		const auto baseLine = statement.front().error.line;
+		const auto key = GetStatementKey(statement);
+
+		std::vector<Node> nodes;
+		bool cached = false;
+
+		if (auto data = options.cache->Load("ast", key))
+		{
+			try
+			{
+				MsgPackReader reader(data.value());
+				nodes = NodeSerializer::DeserializeNodes(reader, baseLine);
+				cached = true;
+			}
+			catch (const MsgPackException&)
+			{
+				// Parse the statement again to replace the corrupt cache entry.
+			}
+		}
+
+		if (!cached)
+		{
+			VectorParser parser;
+			parser.options = options;
+			parser.options.cache.reset();
+			statement >> parser >> nodes;
+
+			std::string data;
+			MsgPackWriter writer(data);
+			NodeSerializer::Serialize(writer, nodes, baseLine);
+			options.cache->Store("ast", key, data);
+		}
+
+		for (auto& node : nodes)
+			co_yield node;
+	}
+}
+
+void Parser::ReadStatement(std::vector<Token>& statement)
+{
+	// Reads the tokens up to and including the next top level full stop, or the end token.
+
+	size_t depth = 0;
+
+	while (!IsDone())
+	{
+		const auto& token = statement.emplace_back(GetNext());
+		Advance();
+
+		if (token.type == Token::Type::End)
+			return;
+		else if (token.type == Token::Type::ParenRoundOpen)
+			++depth;
+		else if (token.type == Token::Type::ParenRoundClose && depth)
+			--depth;
+		else if (token.type == Token::Type::SeparatorDot && !depth)
+			break;
+	}
+
+	// Terminate the statement like a complete program, for the statement parser.
+	if (!statement.empty() && statement.back().type == Token::Type::SeparatorDot)
+	{
+		auto& last = statement.back().error;
+		statement.emplace_back(Token{ .type = Token::Type::End, .error{.line = last.line, .column = last.column + last.length } });
+	}
+}
+
+uint64_t Parser::GetStatementKey(const std::vector<Token>& statement)
+{
+	// Line numbers are hashed relative to the first token, so that a statement that moves to another line
+	// without changing is still found in the cache.
+
+	const auto baseLine = statement.front().error.line;
+
+	CompilationCache::Hasher hasher;
+
+	for (auto& token : statement)
+	{
+		hasher.Add(static_cast<uint64_t>(token.type))
+			.Add(token.value)
+			.Add(static_cast<uint64_t>(token.error.code))
+			.Add(token.error.line - baseLine)
+			.Add(token.error.column)
+			.Add(token.error.length)
+			.Add(token.error.message);
+	}
+
+	return hasher.Get();
+}
+
+void Parser::Synchronize()
+{
+	// Skip the faulty token, then skip ahead to the next declaration start or past the next top level full stop.
+	// An error in a function body only ends at the full stop. Error tokens from the lexer are skipped as well,
+	// to not raise an error for each of them.
+
+	const bool body = std::exchange(inBody, false);
+	size_t depth = 0;
+
+	for (bool faulty = true; !IsDone(); faulty = false)
+	{
+		const auto type = GetNext().type;
+
+		if (type == Token::Type::End)
+			break;
+
+		if (!faulty && !depth && !body && GetFunctionDeclarationTokens().contains(type))
+			break;
+
+		Skip();
+
+		if (type == Token::Type::ParenRoundOpen)
+			++depth;
+		else if (type == Token::Type::ParenRoundClose && depth)
+			--depth;
+		else if (type == Token::Type::SeparatorDot && !depth)
+			break;
+	}
+}
+
+Node Parser::GetSuppressedErrorsNode(size_t errors)
+{
+	const auto suppressed = errors - options.maxErrorsPerDeclaration;
+	return { .type = Node::Type::Error, .token = GetCurrent(), .error = {.code = Node::Error::Code::ParseError, .message = fmt::format("{} more parse errors were suppressed.", suppressed) } };
 }
 
 [[nodiscard]] IParser::OutputT Parser::ParseNonSemantic()
@@ -273,68 +438,139 @@ IParser::OutputT Parser::Parse() noexcept
 	}
 }
 
-TypeSpec Parser::GetPrimitiveDecimalTypeSpec(const std::string& value)
+TypeSpec Parser::GetPrimitiveDecimalTypeSpec(std::string_view value) noexcept
 {
-	// Check the mantissa precision to see whether a double is requried.
+	// Classifies the literal in a single pass over the characters:
+	// [-](\d+)\.(\d+)([eE][+\-]?\d+)?
+	// The significant digits (the integer and fraction digits without leading and trailing zeros)
+	// decide whether the mantissa precision requires a double, and the position of the most significant
+	// digit together with the exponent decides whether the value is within range of a float or double.
+
+	// 2^23 = 23 bit mantissa for 32 bit float
+	// https://blog.demofox.org/2017/11/21/floating-point-precision/
+	constexpr uint64_t floatMantissaLimit = 8388608;
+
+	// Saturation limit for the exponent, well beyond the range of any floating point type.
+	constexpr int exponentLimit = 100000;
+
+	const auto* it = value.data();
+	const auto* end = it + value.size();
+
+	if (it != end && *it == '-')
+		++it;
+
+	uint64_t mantissa = 0;
+	bool requireDouble = false;
+	size_t pendingZeros = 0;
+
+	// The decimal magnitude of the most significant non-zero digit, if any.
+	std::optional<int> magnitude;
 
-	const auto& literalRegex = regexes.GetLiteralDecimal();
-	std::smatch literalMatch;
-	if (!std::regex_match(value, literalMatch, literalRegex))
+	// Reads the integer (position > 0) or fraction (position <= 0) digits.
+	const auto readDigits = [&](int position)
 	{
-		// FIXME: Throw?
-		// Not a valid decimal literal.
+		const auto* begin = it;
+
+		for (; it != end && *it >= '0' && *it <= '9'; ++it, --position)
+		{
+			const unsigned char digit = *it - '0';
+
+			if (!digit)
+			{
+				// Defer zeros until it's known whether they're trailing.
+				if (magnitude.has_value())
+					++pendingZeros;
+
+				continue;
+			}
+
+			if (!magnitude.has_value())
+				magnitude = position - 1;
+
+			for (; !requireDouble && pendingZeros; --pendingZeros)
+			{
+				mantissa *= 10;
+				requireDouble = mantissa >= floatMantissaLimit;
+			}
+
+			pendingZeros = 0;
+
+			if (!requireDouble)
+			{
+				mantissa = mantissa * 10 + digit;
+				requireDouble = mantissa >= floatMantissaLimit;
+			}
+		}
+
+		return it != begin;
+	};
+
+	// The number of integer digits gives the magnitude of the first digit.
+	// std::from_chars doesn't accept a leading plus sign, so such a literal, which has no integer digits, has never been in range.
+	const auto integerDigits = static_cast<int>(std::find_if(it, end, [](char c) { return c < '0' || c > '9'; }) - it);
+	if (!readDigits(integerDigits))
 		return TypeSpec::Invalid();
-	}
 
-	// The integer mantissa is all the digits.
-	const auto digits = literalMatch[1].str() + literalMatch[2].str();
+	if (it == end || *it++ != '.')
+		return TypeSpec::Invalid();
 
-	// Remove the leading and trailing zeros.
-	const auto& trimmedRegex = regexes.GetLiteralIntegerTrimZeros();
-	std::smatch trimmedMatch;
-	if (!std::regex_match(digits, trimmedMatch, trimmedRegex))
-	{
-		// FIXME: Throw?
-		// Invalid regex?
+	if (!readDigits(0))
 		return TypeSpec::Invalid();
-	}
 
-	bool requireDouble = false;
+	int exponent = 0;
 
-	// Convert to integer and check the limit for 32 bit float.
-	// https://blog.demofox.org/2017/11/21/floating-point-precision/
-	const auto trimmedDigits = trimmedMatch[1].str();
-	const auto mantissa = to_int<uint64_t>(trimmedDigits).unsignedValue.value_or(std::numeric_limits<uint64_t>::max());
-	if (mantissa >= 8388608) // 2^23 = 23 bit mantissa for 32 bit float
+	if (it != end && (*it == 'e' || *it == 'E'))
 	{
-		// Higher precision requires a double.
-		requireDouble = true;
-	}
+		++it;
 
-	// Check which range the literal will fit in.
+		bool negativeExponent = false;
+		if (it != end && (*it == '+' || *it == '-'))
+			negativeExponent = *it++ == '-';
 
-	if (!requireDouble)
-	{
-		// Maybe a float will suffice, check if within range.
+		if (it == end)
+			return TypeSpec::Invalid();
 
-		float f{};
-		auto [ptrFloat, errorFloat] = std::from_chars(value.data(), value.data() + value.size(), f);
+		for (; it != end && *it >= '0' && *it <= '9'; ++it)
+			exponent = std::min(exponent * 10 + (*it - '0'), exponentLimit);
 
-		if (errorFloat == std::errc{})
-			return { .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .floatType = true} };
+		if (negativeExponent)
+			exponent = -exponent;
 	}
 
-	// A double is required, but check if within range.
+	if (it != end)
+		return TypeSpec::Invalid();
 
-	double d{};
-	auto [ptrDouble, errorDouble] = std::from_chars(value.data(), value.data() + value.size(), d);
+	// Zero is in range of every type.
+	if (!magnitude.has_value())
+		return { .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .floatType = true} };
+
+	// The value is within [10^e, 10^(e+1)).
+	const int e = magnitude.value() + exponent;
 
-	if (errorDouble == std::errc{})
+	// Well within the normal range of a float (FLT_MIN ~ 1.2e-38, FLT_MAX ~ 3.4e38).
+	if (!requireDouble && e >= -37 && e <= 37)
+		return { .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .floatType = true} };
+
+	// Well within the normal range of a double (DBL_MIN ~ 2.2e-308, DBL_MAX ~ 1.8e308).
+	if (e >= -307 && e <= 307 && (requireDouble || e < -46 || e > 38))
 		return { .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 64, .floatType = true} };
 
-	// FIXME: Throw?
-	// Not a number or out of range.
-	return TypeSpec::Invalid();
+	// Close to a range limit, let the conversion decide.
+
+	double d{};
+	auto [ptr, error] = std::from_chars(value.data(), value.data() + value.size(), d);
+
+	if (error != std::errc{})
+	{
+		// Not a number or out of range.
+		return TypeSpec::Invalid();
+	}
+
+	const auto f = static_cast<float>(d);
+	if (!requireDouble && std::isfinite(f) && f != 0)
+		return { .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .floatType = true} };
+
+	return { .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 64, .floatType = true} };
 }
 
 TypeSpec Parser::ParseTypeSpec()
@@ -415,7 +651,7 @@ TypeSpec Parser::ParseTypeSpec()
 		}
 	}
 
-	return t;
+	return TypeTable::Intern(std::move(t));
 }
 
 ParameterList Parser::ParseParameterList()
@@ -448,7 +684,7 @@ ParameterList Parser::ParseParameterList()
 		}
 		else
 		{
-			parameter->type = {.kind = TypeSpec::Kind::Any};
+			parameter->type = TypeTable::Intern({ .kind = TypeSpec::Kind::Any });
 		}
 
 		// Name and/or type must be specified
@@ -606,7 +842,7 @@ Node Parser::ParseFunctionDeclaration(std::shared_ptr<Context> context)
 		if (node.value.empty())
 		{
 			// The anonymous main function has no output type.
-			node.outType = { .kind = TypeSpec::Kind::None };
+			node.outType = TypeTable::Intern({ .kind = TypeSpec::Kind::None });
 		}
 
 		auto innerContext = make<Context>::shared({ .parent = context });
@@ -614,7 +850,9 @@ Node Parser::ParseFunctionDeclaration(std::shared_ptr<Context> context)
 		for (const auto& parameter : node.parameters)
 			innerContext->AddVariableSymbol(parameter);
 
+		inBody = true;
 		node.children.emplace_back(ParseExpression(innerContext));
+		inBody = false;
 	}
 	else if (Accept(Token::Type::SeparatorDot))
 	{
@@ -653,6 +891,9 @@ Node Parser::ParseExpression(std::shared_ptr<Context> context)
 
 	bool expectRightOperand = false;
 
+	// The expression token is the terminator, which is never beyond the full stop that ends the statement.
+	Token terminator;
+
 	for (;;)
 	{
 		if (expectRightOperand)
@@ -698,8 +939,14 @@ Node Parser::ParseExpression(std::shared_ptr<Context> context)
 			expectRightOperand = true;
 		}
 		// TODO: Selector, bind
-		else if (Accept(Token::Type::SeparatorDot) || Peek(GetExpressionTerminatorTokens()))
+		else if (Accept(Token::Type::SeparatorDot))
+		{
+			terminator = GetCurrent();
+			break;
+		}
+		else if (Peek(GetExpressionTerminatorTokens()))
 		{
+			terminator = GetNext();
 			break;
 		}
 		else
@@ -714,7 +961,7 @@ Node Parser::ParseExpression(std::shared_ptr<Context> context)
 	if (operations.empty())
 		return input;
 	else
-		return { .type = Node::Type::Expression, .token = GetNext(), .children = std::move(operations) };
+		return { .type = Node::Type::Expression, .token = terminator, .children = std::move(operations) };
 }
 
 // Returns Tuple, ExpressionList, Expression or Empty
@@ -778,15 +1025,15 @@ Node Parser::ParseOperand(std::shared_ptr<Context> context)
 		switch (GetCurrent().type)
 		{
 		case Token::Type::LiteralInteger:
-			node.outType = GetPrimitiveIntegerTypeSpec(GetCurrent().value);
+			node.outType = TypeTable::Intern(GetPrimitiveIntegerTypeSpec(GetCurrent().value));
 			break;
 
 		case Token::Type::LiteralDecimal:
-			node.outType = GetPrimitiveDecimalTypeSpec(GetCurrent().value);
+			node.outType = TypeTable::Intern(GetPrimitiveDecimalTypeSpec(GetCurrent().value));
 			break;
 
 		case Token::Type::LiteralString:
-			node.outType = TypeSpec{ .kind = TypeSpec::Kind::Primitive, .arrayDims{0}, .primitive{.bits = 8, .signedType = true} };
+			node.outType = TypeTable::Intern({ .kind = TypeSpec::Kind::Primitive, .arrayDims{0}, .primitive{.bits = 8, .signedType = true} });
 			break;
 		}
 	}
@@ -1,12 +1,23 @@
 #pragma once
 #include "ParserBase.h"
-#include "ParserRegexes.h"
+#include "CompilationCache.h"
 
 class Parser : public ParserBase
 {
 	friend class ParserTest;
+	friend class ConstantFolder;
 
 public:
+	struct Options
+	{
+		// The maximum number of error nodes to yield between two successfully parsed declarations.
+		// Further parse errors are coalesced into a single error node.
+		size_t maxErrorsPerDeclaration = 10;
+
+		// Caches the syntax trees of top-level statements, if set.
+		std::shared_ptr<CompilationCache> cache;
+	} options;
+
 	[[nodiscard]] OutputT Parse() noexcept override;
 
 private:
@@ -24,6 +35,18 @@ private:
 
 	std::shared_ptr<Context> currentContext;
 
+	// Set while a function body is parsed. A parse error in a body skips to the end of the declaration,
+	// since the calls in the body would be taken for declarations.
+	bool inBody{};
+
+	[[nodiscard]] OutputT ParseDeclarations();
+	[[nodiscard]] OutputT ParseCachedDeclarations();
+	void ReadStatement(std::vector<Token>& statement);
+	[[nodiscard]] static uint64_t GetStatementKey(const std::vector<Token>& statement);
+
+	void Synchronize();
+	[[nodiscard]] Node GetSuppressedErrorsNode(size_t errors);
+
 	[[nodiscard]] OutputT ParseNonSemantic();
 	[[nodiscard]] Node ParseFunctionDeclaration(std::shared_ptr<Context> context);
 	[[nodiscard]] Node ParseExpression(std::shared_ptr<Context> context);
@@ -125,9 +148,7 @@ private:
 		return TypeSpec::Invalid();
 	}
 
-	[[nodiscard]] TypeSpec GetPrimitiveDecimalTypeSpec(const std::string& value);
-
-	ParserRegexes regexes;
+	[[nodiscard]] static TypeSpec GetPrimitiveDecimalTypeSpec(std::string_view value) noexcept;
 };
 
 using RangeParser = BasicRangeParser<Parser>;
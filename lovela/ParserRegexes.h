@@ -1,7 +0,0 @@
-#pragma once
-
-struct ParserRegexes
-{
-	const std::regex& GetLiteralDecimal() const;
-	const std::regex& GetLiteralIntegerTrimZeros() const;
-};
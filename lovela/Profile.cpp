@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "Profile.h"
+
+void Profile::Read(std::istream& input)
+{
+	std::string line;
+	while (std::getline(input, line))
+	{
+		if (line.ends_with('\r'))
+			line.pop_back();
+
+		uint64_t count{};
+		const auto [end, error] = std::from_chars(line.data(), line.data() + line.size(), count);
+		if (error != std::errc() || end == line.data() + line.size() || *end != '\t')
+			continue;
+
+		// The name is the last column, and may contain tabs.
+		size_t tab = end - line.data();
+		for (int column = 0; column < 2 && tab != std::string::npos; ++column)
+			tab = line.find('\t', tab + 1);
+
+		if (tab != std::string::npos)
+			calls[line.substr(tab + 1)] += count;
+	}
+
+	// The hot functions are the most called functions that together have 90% of all calls.
+	std::vector<uint64_t> counts;
+	uint64_t total = 0;
+	for (auto& [name, count] : calls)
+	{
+		counts.push_back(count);
+		total += count;
+	}
+
+	std::ranges::sort(counts, std::ranges::greater{});
+
+	hotCalls = 0;
+	uint64_t sum = 0;
+	for (auto count : counts)
+	{
+		if (sum >= total - total / 10)
+			break;
+
+		sum += count;
+		hotCalls = count;
+	}
+}
+
+uint64_t Profile::GetCalls(const Node& function) const
+{
+	const auto iter = calls.find(GetName(function));
+	return iter != calls.end() ? iter->second : 0;
+}
+
+Profile::Heat Profile::GetHeat(const Node& function) const
+{
+	if (calls.empty())
+		return Heat::Unknown;
+
+	const auto count = GetCalls(function);
+	return !count ? Heat::Cold : count >= hotCalls ? Heat::Hot : Heat::Normal;
+}
+
+std::string Profile::GetName(const Node& function)
+{
+	// The profiler names the main function main.
+	return function.value.empty() ? std::string("main") : function.GetQualifiedName();
+}
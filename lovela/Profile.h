@@ -0,0 +1,42 @@
+#pragma once
+#include "Node.h"
+
+// The call counts of the functions of a lovela program, from a run of the program built with CoderCpp::Options::profile,
+// which guide the optimization of the next build of the program.
+//
+// The profile file is the text report that lovela::profiler writes to stderr when the program exits.
+// Each line has four tab-separated columns: the number of calls, the inclusive and exclusive milliseconds,
+// and the qualified lovela name of the function, or main. Lines that don't start with a number, like the header, are ignored.
+// The calls of a function on several lines are added, so the profiles of several runs can be concatenated.
+// Functions that aren't listed weren't called.
+class Profile
+{
+public:
+	enum class Heat
+	{
+		// The profile is empty.
+		Unknown,
+		// The function wasn't called.
+		Cold,
+		Normal,
+		// The function is one of the most called functions, which together have most of the calls.
+		Hot,
+	};
+
+	void Read(std::istream& input);
+
+	[[nodiscard]] bool IsEmpty() const noexcept
+	{
+		return calls.empty();
+	}
+
+	[[nodiscard]] uint64_t GetCalls(const Node& function) const;
+	[[nodiscard]] Heat GetHeat(const Node& function) const;
+
+private:
+	[[nodiscard]] static std::string GetName(const Node& function);
+
+	std::unordered_map<std::string, uint64_t> calls;
+	// The least number of calls of a hot function.
+	uint64_t hotCalls{};
+};
@@ -0,0 +1,96 @@
+#include "pch.h"
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t threads)
+{
+	if (!threads)
+		threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+	workers.reserve(threads);
+
+	for (size_t i = 0; i < threads; ++i)
+		workers.emplace_back([this](std::stop_token stopToken) { Work(stopToken); });
+}
+
+ThreadPool::~ThreadPool()
+{
+	for (auto& worker : workers)
+		worker.request_stop();
+
+	condition.notify_all();
+}
+
+void ThreadPool::Work(std::stop_token stopToken)
+{
+	for (;;)
+	{
+		std::function<void()> task;
+
+		{
+			std::unique_lock lock(mutex);
+			if (!condition.wait(lock, stopToken, [this] { return !tasks.empty(); }))
+				return;
+
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+
+		task();
+	}
+}
+
+void ThreadPool::ForEach(size_t count, const std::function<void(size_t)>& function)
+{
+	if (!count)
+		return;
+
+	// The state is shared with the helper tasks, since a helper may start after all work is done.
+	struct State
+	{
+		std::function<void(size_t)> function;
+		size_t count{};
+		std::atomic<size_t> next{};
+		std::atomic<size_t> completed{};
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::exception_ptr exception;
+	};
+
+	auto state = std::make_shared<State>();
+	state->function = function;
+	state->count = count;
+
+	const auto run = [](State& state)
+	{
+		for (auto index = state.next++; index < state.count; index = state.next++)
+		{
+			try
+			{
+				state.function(index);
+			}
+			catch (...)
+			{
+				std::scoped_lock lock(state.mutex);
+				if (!state.exception)
+					state.exception = std::current_exception();
+			}
+
+			if (++state.completed == state.count)
+			{
+				std::scoped_lock lock(state.mutex);
+				state.condition.notify_all();
+			}
+		}
+	};
+
+	for (size_t i = 1, e = std::min(count, workers.size()); i < e; ++i)
+		static_cast<void>(Submit([state, run] { run(*state); }));
+
+	run(*state);
+
+	std::unique_lock lock(state->mutex);
+	state->condition.wait(lock, [&] { return state->completed == state->count; });
+
+	if (state->exception)
+		std::rethrow_exception(state->exception);
+}
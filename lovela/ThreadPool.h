@@ -0,0 +1,46 @@
+#pragma once
+
+// Fixed size pool of worker threads that run submitted tasks in submission order.
+class ThreadPool
+{
+public:
+	// Creates one worker thread per hardware thread if the thread count is zero.
+	ThreadPool(size_t threads = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	[[nodiscard]] size_t GetThreadCount() const noexcept
+	{
+		return workers.size();
+	}
+
+	template <typename FunctionT>
+	[[nodiscard]] auto Submit(FunctionT&& function) -> std::future<std::invoke_result_t<FunctionT>>
+	{
+		auto task = std::make_shared<std::packaged_task<std::invoke_result_t<FunctionT>()>>(std::forward<FunctionT>(function));
+		auto result = task->get_future();
+
+		{
+			std::scoped_lock lock(mutex);
+			tasks.emplace_back([task] { (*task)(); });
+		}
+
+		condition.notify_one();
+		return result;
+	}
+
+	// Calls the function for each index in [0, count) and waits for all calls to complete.
+	// The calling thread takes part in the work, so it's safe to call from within a task.
+	// Rethrows the first exception thrown by the function.
+	void ForEach(size_t count, const std::function<void(size_t)>& function);
+
+private:
+	void Work(std::stop_token stopToken);
+
+	std::mutex mutex;
+	std::condition_variable_any condition;
+	std::deque<std::function<void()>> tasks;
+	std::vector<std::jthread> workers;
+};
@@ -1,6 +1,9 @@
 #pragma once
 #include "NameSpace.h"
 
+// Identifies an interned type. See TypeTable.
+using TypeId = uint32_t;
+
 struct TypeSpec
 {
 	enum class Kind
@@ -38,16 +41,50 @@ struct TypeSpec
 		}
 	} primitive{};
 
+	// Set by TypeTable::Intern, and zero if the type isn't interned.
+	// The mutators reset it, since a modified type is no longer the interned type.
+	TypeId id{};
+
 	[[nodiscard]] constexpr bool Is(Kind k) const noexcept { return kind == k; }
 
-	[[nodiscard]] constexpr auto operator<=>(const TypeSpec& rhs) const noexcept = default;
+	TypeSpec& SetName(std::string value)
+	{
+		name = std::move(value);
+		id = {};
+		return *this;
+	}
+
+	TypeSpec& SetPrimitive(Primitive value) noexcept
+	{
+		primitive = value;
+		id = {};
+		return *this;
+	}
+
+	[[nodiscard]] constexpr bool operator==(const TypeSpec& rhs) const noexcept
+	{
+		// Interned types are equal if and only if their ids are equal.
+		if (id && rhs.id)
+			return id == rhs.id;
+
+		return kind == rhs.kind
+			&& name == rhs.name
+			&& nameSpace == rhs.nameSpace
+			&& arrayDims == rhs.arrayDims
+			&& primitive == rhs.primitive;
+	}
+
+	[[nodiscard]] std::size_t GetHash() const noexcept;
 
 	[[nodiscard]] void PrintPrimitiveName(std::ostream& stream) const
 	{
 		stream << (primitive.floatType ? 'f' : (primitive.signedType ? 'i' : 'u')) << static_cast<unsigned int>(primitive.bits);
 	}
 
-	[[nodiscard]] std::string GetQualifiedName() const
+	// Returns the cached name if the type is interned.
+	[[nodiscard]] std::string GetQualifiedName() const;
+
+	[[nodiscard]] std::string FormatQualifiedName() const
 	{
 		std::ostringstream s;
 
@@ -79,6 +116,15 @@ private:
 	static constexpr const char* noneTypeName = "()";
 };
 
+template <>
+struct std::hash<TypeSpec>
+{
+	[[nodiscard]] std::size_t operator()(const TypeSpec& type) const noexcept
+	{
+		return type.GetHash();
+	}
+};
+
 inline std::ostream& operator<<(std::ostream& stream, const TypeSpec& typeSpec)
 {
 	typeSpec.Print(stream);
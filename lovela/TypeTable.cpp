@@ -0,0 +1,100 @@
+#include "pch.h"
+#include "TypeTable.h"
+#include "CompilationCache.h"
+
+TypeSpec TypeTable::Intern(TypeSpec type)
+{
+	if (type.id)
+		return type;
+
+	auto& table = Get();
+
+	{
+		std::shared_lock lock(table.mutex);
+		if (const auto iter = table.ids.find(type); iter != table.ids.end())
+		{
+			type.id = iter->second;
+			return type;
+		}
+	}
+
+	std::unique_lock lock(table.mutex);
+
+	// Another thread may have added the type while the lock was released.
+	const auto index = table.size.load(std::memory_order_relaxed);
+	auto [iter, added] = table.ids.try_emplace(type, static_cast<TypeId>(index + 1));
+	if (added)
+	{
+		const auto [segment, offset] = GetSegment(index);
+		if (!offset)
+		{
+			table.segments[segment] = std::make_unique<Entry[]>(firstSegmentSize << segment);
+			table.segmentEntries[segment].store(table.segments[segment].get(), std::memory_order_release);
+		}
+
+		table.segments[segment][offset] = {
+			.type = type,
+			.hash = Hash(type),
+			.qualifiedName = type.FormatQualifiedName(),
+		};
+		table.segments[segment][offset].type.id = iter->second;
+		table.size.store(index + 1, std::memory_order_release);
+	}
+
+	type.id = iter->second;
+	return type;
+}
+
+const TypeTable::Entry& TypeTable::GetEntry(TypeId id) noexcept
+{
+	// The id was returned by Intern after the entry was added, so its segment has been published.
+	const auto [segment, offset] = GetSegment(id - 1);
+	return Get().segmentEntries[segment].load(std::memory_order_acquire)[offset];
+}
+
+std::size_t TypeTable::GetSize()
+{
+	return Get().size.load(std::memory_order_acquire);
+}
+
+std::pair<std::size_t, std::size_t> TypeTable::GetSegment(std::size_t index) noexcept
+{
+	// Segment n starts at index firstSegmentSize * (2^n - 1).
+	const auto segment = static_cast<std::size_t>(std::bit_width(index / firstSegmentSize + 1) - 1);
+	return { segment, index - firstSegmentSize * ((std::size_t{ 1 } << segment) - 1) };
+}
+
+std::size_t TypeTable::Hash(const TypeSpec& type) noexcept
+{
+	CompilationCache::Hasher hasher;
+
+	hasher.Add(static_cast<uint64_t>(type.kind)).Add(type.name);
+
+	hasher.Add(type.nameSpace.root).Add(type.nameSpace.parts.size());
+	for (auto& part : type.nameSpace.parts)
+		hasher.Add(part);
+
+	hasher.Add(type.arrayDims.size());
+	for (auto length : type.arrayDims)
+		hasher.Add(length);
+
+	hasher.Add(type.primitive.bits).Add(type.primitive.signedType).Add(type.primitive.floatType);
+
+	return static_cast<std::size_t>(hasher.Get());
+}
+
+TypeTable& TypeTable::Get()
+{
+	static TypeTable table;
+	return table;
+}
+
+std::size_t TypeSpec::GetHash() const noexcept
+{
+	return id ? TypeTable::GetEntry(id).hash : TypeTable::Hash(*this);
+}
+
+std::string TypeSpec::GetQualifiedName() const
+{
+	return id ? TypeTable::GetEntry(id).qualifiedName : FormatQualifiedName();
+}
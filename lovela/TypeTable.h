@@ -0,0 +1,52 @@
+#pragma once
+#include "Token.h"
+#include "TypeSpec.h"
+
+// Interns types, so that each distinct type is stored once and identified by a small integer id.
+// The hash and qualified name of an interned type are generated when it's interned, and interned types are compared and hashed by id.
+// Backends keep the names of their own languages by id. The table is shared by all threads, and types are never removed from it.
+class TypeTable
+{
+public:
+	struct Entry
+	{
+		TypeSpec type;
+		std::size_t hash{};
+		std::string qualifiedName;
+	};
+
+	// Returns the type with its id set, and adds it to the table if it's new.
+	[[nodiscard]] static TypeSpec Intern(TypeSpec type);
+
+	// The id must have been returned by Intern. Entries are read without a lock.
+	[[nodiscard]] static const Entry& GetEntry(TypeId id) noexcept;
+
+	[[nodiscard]] static std::size_t GetSize();
+
+	// Hashes the type by value, ignoring the id.
+	[[nodiscard]] static std::size_t Hash(const TypeSpec& type) noexcept;
+
+private:
+	struct ValueHash
+	{
+		[[nodiscard]] std::size_t operator()(const TypeSpec& type) const noexcept
+		{
+			return Hash(type);
+		}
+	};
+
+	[[nodiscard]] static TypeTable& Get();
+
+	// The entries are stored in segments that are never moved, each twice the size of the previous one,
+	// so that the segment of an entry is found from its index, and read while other entries are added.
+	static constexpr std::size_t firstSegmentSize = 64;
+	static constexpr std::size_t segmentCount = 32;
+
+	[[nodiscard]] static std::pair<std::size_t, std::size_t> GetSegment(std::size_t index) noexcept;
+
+	std::shared_mutex mutex;
+	std::array<std::unique_ptr<Entry[]>, segmentCount> segments;
+	std::array<std::atomic<Entry*>, segmentCount> segmentEntries{};
+	std::atomic<std::size_t> size;
+	std::unordered_map<TypeSpec, TypeId, ValueHash> ids;
+};
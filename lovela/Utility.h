@@ -384,6 +384,28 @@ private:
 using co_split = basic_co_split<char>;
 using co_wsplit = basic_co_split<wchar_t>;
 
+// Writes the content to the file, unless the file already holds exactly that content.
+// Leaving an unchanged file untouched keeps its timestamp, so build systems don't rebuild its dependents.
+// Returns true if the file was written, false if it was already up to date.
+// Throws std::runtime_error if the file can't be written.
+inline bool write_if_changed(const std::filesystem::path& path, std::string_view content)
+{
+	std::error_code error;
+	if (std::filesystem::file_size(path, error) == content.size() && !error)
+	{
+		std::ifstream existing(path, std::ios::binary);
+		std::string data(content.size(), '\0');
+		if (existing.read(data.data(), data.size()) && data == content)
+			return false;
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.write(content.data(), content.size()))
+		throw std::runtime_error("Failed to write " + path.string());
+
+	return true;
+}
+
 // https://www.reddit.com/r/cpp/comments/g05m1r/stdunique_ptr_and_braced_initialization/
 template <typename T>
 struct make
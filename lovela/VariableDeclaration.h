@@ -6,7 +6,7 @@ struct VariableDeclaration
 	std::string name;
 	TypeSpec type{};
 
-	[[nodiscard]] auto operator<=>(const VariableDeclaration& rhs) const noexcept = default;
+	[[nodiscard]] bool operator==(const VariableDeclaration& rhs) const noexcept = default;
 
 	[[nodiscard]] void Print(std::ostream& stream) const
 	{
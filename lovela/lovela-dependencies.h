@@ -5,8 +5,12 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <deque>
 #include <algorithm>
+#include <numeric>
+#include <bit>
 #include <memory>
 #include <functional>
 #include <iostream>
@@ -15,6 +19,19 @@
 #include <regex>
 #include <ranges>
 #include <charconv>
+#include <cmath>
+#include <filesystem>
+#include <optional>
+#include <variant>
+#include <span>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <future>
+#include <atomic>
+#include <chrono>
+#include <stop_token>
 
 #include "fmt/fmt/format.h"
 #include "fmt/fmt/ranges.h"
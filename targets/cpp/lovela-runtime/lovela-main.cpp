@@ -11,6 +11,13 @@ int wmain(int argc, wchar_t* argv[])
 	}
 	lovela::None in;
 	lovela::main(context, in);
+
+	wchar_t* format{};
+	size_t size{};
+	_wdupenv_s(&format, &size, L"LOVELA_PROFILE");
+	lovela::profiler::report(std::cerr, format && std::wstring_view(format) == L"json");
+	free(format);
+
 	return context.error.code;
 }
 
@@ -21,6 +28,10 @@ int main(int argc, char* argv[])
 	lovela::context context{ .parameters{argv + 1, argv + argc} };
 	lovela::None in;
 	lovela::main(context, in);
+
+	const char* format = std::getenv("LOVELA_PROFILE");
+	lovela::profiler::report(std::cerr, format && std::string_view(format) == "json");
+
 	return context.error.code;
 }
 
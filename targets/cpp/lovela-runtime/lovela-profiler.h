@@ -0,0 +1,221 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lovela
+{
+	// Counts the calls and measures the time of the functions of programs generated with CoderCpp::Options::profile.
+	// Each thread accumulates its own counters, and adds them to the totals when it exits, so that calls don't contend.
+	// The inclusive time of a function includes the functions that it calls, and the exclusive time doesn't.
+	class profiler
+	{
+	public:
+		using clock = std::chrono::steady_clock;
+
+		// A generated function, registered once by a static local of the function.
+		class function
+		{
+		public:
+			explicit function(std::string_view name)
+				: index(instance().add(name))
+			{
+			}
+
+			const size_t index;
+		};
+
+		// Measures a call of a function while in scope.
+		class scope
+		{
+		public:
+			// The first call of a function on a thread grows the counters of the thread, which may throw.
+			explicit scope(const function& function)
+				: index(function.index)
+				, parent(current())
+				, start(clock::now())
+			{
+				++counters().get(index).depth;
+				current() = this;
+			}
+
+			~scope()
+			{
+				const auto elapsed = clock::now() - start;
+				current() = parent;
+
+				auto& counter = counters().get(index);
+				++counter.calls;
+				counter.exclusive += elapsed - children;
+
+				// Recursive calls are included in the outermost call of the function.
+				if (!--counter.depth)
+					counter.inclusive += elapsed;
+
+				if (parent)
+					parent->children += elapsed;
+			}
+
+			scope(const scope&) = delete;
+			scope& operator=(const scope&) = delete;
+
+		private:
+			static scope*& current() noexcept
+			{
+				thread_local scope* current{};
+				return current;
+			}
+
+			const size_t index;
+			scope* const parent;
+			const clock::time_point start;
+			clock::duration children{};
+		};
+
+		// Writes the calls and times of the functions by decreasing exclusive time, as text or JSON.
+		// Template instantiations of a function are reported together. Writes nothing if no function was registered.
+		static void report(std::ostream& stream, bool json)
+		{
+			auto& profiler = instance();
+			profiler.merge(counters().functions);
+
+			struct total
+			{
+				std::string_view name;
+				uint64_t calls{};
+				clock::duration inclusive{};
+				clock::duration exclusive{};
+			};
+
+			std::vector<total> totals;
+
+			{
+				std::scoped_lock lock(profiler.mutex);
+
+				std::map<std::string_view, size_t> indexes;
+				for (size_t i = 0; i < profiler.names.size(); ++i)
+				{
+					const auto [iter, added] = indexes.try_emplace(profiler.names[i], totals.size());
+					if (added)
+						totals.push_back({ .name = profiler.names[i] });
+
+					auto& total = totals[iter->second];
+					total.calls += profiler.totals[i].calls;
+					total.inclusive += profiler.totals[i].inclusive;
+					total.exclusive += profiler.totals[i].exclusive;
+				}
+			}
+
+			if (totals.empty())
+				return;
+
+			std::ranges::stable_sort(totals, std::ranges::greater{}, &total::exclusive);
+
+			const auto ms = [](clock::duration duration)
+			{
+				return std::chrono::duration<double, std::milli>(duration).count();
+			};
+
+			if (json)
+			{
+				stream << "[\n";
+
+				for (bool sep{}; auto& total : totals)
+				{
+					stream << (sep ? ",\n" : "") << "  { \"function\": \"";
+
+					for (auto c : total.name)
+						stream << (c == '"' || c == '\\' ? "\\" : "") << c;
+
+					stream << "\", \"calls\": " << total.calls
+						<< ", \"inclusive_ms\": " << ms(total.inclusive)
+						<< ", \"exclusive_ms\": " << ms(total.exclusive) << " }";
+
+					sep = true;
+				}
+
+				stream << "\n]\n";
+			}
+			else
+			{
+				stream << "Calls\tInclusive ms\tExclusive ms\tFunction\n";
+
+				for (auto& total : totals)
+					stream << total.calls << '\t' << ms(total.inclusive) << '\t' << ms(total.exclusive) << '\t' << total.name << '\n';
+			}
+		}
+
+	private:
+		struct counter
+		{
+			uint64_t calls{};
+			clock::duration inclusive{};
+			clock::duration exclusive{};
+			size_t depth{};
+		};
+
+		// The counters of the calling thread, which are added to the totals when the thread exits.
+		struct thread_counters
+		{
+			std::vector<counter> functions;
+
+			~thread_counters()
+			{
+				instance().merge(functions);
+			}
+
+			counter& get(size_t index)
+			{
+				if (index >= functions.size())
+					functions.resize(index + 1);
+
+				return functions[index];
+			}
+		};
+
+		static profiler& instance()
+		{
+			static profiler profiler;
+			return profiler;
+		}
+
+		static thread_counters& counters()
+		{
+			thread_local thread_counters counters;
+			return counters;
+		}
+
+		size_t add(std::string_view name)
+		{
+			std::scoped_lock lock(mutex);
+			names.emplace_back(name);
+			totals.emplace_back();
+			return names.size() - 1;
+		}
+
+		void merge(std::vector<counter>& functions)
+		{
+			std::scoped_lock lock(mutex);
+
+			for (size_t i = 0; i < functions.size(); ++i)
+			{
+				totals[i].calls += functions[i].calls;
+				totals[i].inclusive += functions[i].inclusive;
+				totals[i].exclusive += functions[i].exclusive;
+			}
+
+			functions.clear();
+		}
+
+		std::mutex mutex;
+		std::vector<std::string> names;
+		std::vector<counter> totals;
+	};
+}
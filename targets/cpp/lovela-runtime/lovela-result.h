@@ -0,0 +1,101 @@
+// The errors of the programs that CoderCpp generates with Options::results, which return them as values.
+// std::expected requires C++23, so lovela.h doesn't include this header, and the generated source files include it only in that mode.
+#pragma once
+#include <expected>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+namespace lovela
+{
+	class error;
+
+	// An error with a static message, for functions that return their errors as a result
+	// instead of throwing a lovela::error, which copies its strings and unwinds the stack.
+	// The code is interned by the message, so the same message always has the same code. Code 0 is no error.
+	class error_code
+	{
+	public:
+		constexpr error_code() noexcept = default;
+
+		// The message is copied once, when it's interned. Interning takes a lock,
+		// so an error is constructed once, as a static local, and copied when it's returned.
+		explicit error_code(std::string_view message)
+		{
+			const auto& [interned, code] = intern(message);
+			index = code;
+			text = interned.c_str();
+		}
+
+		[[nodiscard]] constexpr int code() const noexcept
+		{
+			return index;
+		}
+
+		[[nodiscard]] constexpr const char* message() const noexcept
+		{
+			return text;
+		}
+
+		[[nodiscard]] constexpr explicit operator bool() const noexcept
+		{
+			return index != 0;
+		}
+
+		[[nodiscard]] constexpr bool operator==(const error_code& rhs) const noexcept
+		{
+			return index == rhs.index;
+		}
+
+	private:
+		// The nodes of the map keep the interned messages at the same address.
+		static const std::pair<const std::string, int>& intern(std::string_view message)
+		{
+			static std::mutex mutex;
+			static std::unordered_map<std::string, int> codes;
+
+			const std::lock_guard lock(mutex);
+			return *codes.try_emplace(std::string(message), static_cast<int>(codes.size() + 1)).first;
+		}
+
+		int index{};
+		const char* text{ "" };
+	};
+
+	// The value of a function that may fail, or its error.
+	// The caller checks the result and returns the error on, or handles it, with a branch instead of a catch.
+	template <typename T>
+	using result = std::expected<T, error_code>;
+
+	// Returns the error from a function with any result type.
+	[[nodiscard]] inline std::unexpected<error_code> fail(error_code error) noexcept
+	{
+		return std::unexpected<error_code>(error);
+	}
+
+	// Calls a function that throws its errors, like the functions that the program doesn't define,
+	// and returns its value, or its error as a result. The error type is a template parameter,
+	// so that this header doesn't depend on lovela.h, which defines lovela::error.
+	template <typename Error = error, typename Function>
+	[[nodiscard]] auto attempt(Function&& function) -> result<std::remove_cvref_t<std::invoke_result_t<Function>>>
+	{
+		try
+		{
+			if constexpr (std::is_void_v<std::invoke_result_t<Function>>)
+			{
+				std::forward<Function>(function)();
+				return {};
+			}
+			else
+			{
+				return std::forward<Function>(function)();
+			}
+		}
+		catch (const Error& exception)
+		{
+			return fail(error_code(exception.message));
+		}
+	}
+}
@@ -0,0 +1,2 @@
+// Creates the precompiled header. Build the generated source files with lovela-runtime-pch.h as their precompiled header to use it.
+#include "lovela-runtime-pch.h"
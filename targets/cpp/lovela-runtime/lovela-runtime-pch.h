@@ -0,0 +1,5 @@
+// Precompiled header for generated programs, with the lovela runtime and the standard headers that it includes.
+// These don't change with the program, so the C++ compiler parses them once instead of for every source file.
+// The generated source files include it first if CoderCpp::Options::runtime is CoderCpp::Runtime::PrecompiledHeader.
+#pragma once
+#include "lovela.h"
@@ -0,0 +1,28 @@
+// The lovela runtime as a C++20 module, which the C++ compiler builds once for all source files of the program.
+// lovela-program.h imports it if the generated source files define LOVELA_RUNTIME_MODULE, see CoderCpp::Runtime::Module.
+module;
+#include "lovela.h"
+export module lovela.runtime;
+
+// The runtime is exported by using-declarations, so that the entities are the same as when lovela.h is included,
+// and the program can define lovela::main.
+export namespace lovela
+{
+	using lovela::None;
+	using lovela::small_type;
+	using lovela::param_t;
+	using lovela::variable;
+	using lovela::fixed_array;
+	using lovela::dynamic_array;
+	using lovela::default_tuple_names_t;
+	using lovela::fixed_tuple;
+	using lovela::named_tuple;
+	using lovela::to_fixed_tuple;
+
+	using lovela::stream;
+	using lovela::streams;
+	using lovela::error;
+	using lovela::context;
+	using lovela::profiler;
+	using lovela::main;
+}
@@ -88,6 +88,13 @@ namespace lovela
 	{
 	};
 
+	// Small values that are cheap to copy are passed by value, and other values by reference.
+	template <typename T>
+	concept small_type = sizeof(T) <= 16 && std::is_trivially_copyable_v<T>;
+
+	template <typename T>
+	using param_t = std::conditional_t<small_type<T>, T, const T&>;
+
 	template <typename Item>
 	struct variable
 	{
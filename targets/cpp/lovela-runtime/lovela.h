@@ -11,6 +11,7 @@
 #include <algorithm>
 #include "utfcpp/utf8.h"
 #include "lovela-types.h"
+#include "lovela-profiler.h"
 
 namespace lovela
 {
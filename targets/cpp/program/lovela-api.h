@@ -32,6 +32,15 @@
 #endif
 #endif
 
+// Functions that are called the most or not at all in the profile of the program, see CoderCpp::Options::profileUse.
+#if defined(__GNUC__)
+#define LOVELA_HOT __attribute__((hot))
+#define LOVELA_COLD __attribute__((cold))
+#else
+#define LOVELA_HOT
+#define LOVELA_COLD
+#endif
+
 typedef bool l_i1;
 typedef char l_i8;
 typedef short l_i16;
@@ -1,16 +1,32 @@
 
 #include "lovela-program.h"
 
-auto f_puts(lovela::context& context, auto in)
+auto f_puts(lovela::context& context, auto&& in)
 {
   static_cast<void>(context);
   return puts(in);
 }
 
+constexpr l_i32 f_double(l_i32 in)
+{
+  auto& v1 = in; static_cast<void>(v1);
+  auto v2 = v1 * 2; static_cast<void>(v2);
+  return v2;
+}
+
+constexpr l_i32 f_quadruple(l_i32 in)
+{
+  auto& v1 = in; static_cast<void>(v1);
+  auto v2 = f_double(f_double(std::forward<decltype(in)>(v1))); static_cast<void>(v2);
+  return v2;
+}
+
 lovela::None lovela::main(lovela::context& context, lovela::None in)
 {
   static_cast<void>(context);
   auto& v1 = in; static_cast<void>(v1);
-  const auto v2 = f_puts(context, "Hello, World!"); static_cast<void>(v2);
+  auto v2 = f_puts(context, "Hello, World!"); static_cast<void>(v2);
   return {};
 }
+
+static_assert(f_quadruple(3) == 12);
@@ -1,4 +1,14 @@
 // This is the single header that the generated lovela-program.cpp file includes. It must include all that is needed for the program to build.
 #pragma once
+#ifdef LOVELA_RUNTIME_MODULE
+// The lovela.runtime module doesn't export macros or the standard library.
+#define LOVELA
+#include <utility>
+#else
 #include "..\lovela-runtime\lovela.h"
+#endif
 #include "lovela-api.h"
+#ifdef LOVELA_RUNTIME_MODULE
+// Imported after all headers, since compilers may fail to merge the headers that the module includes with the same headers included after it.
+import lovela.runtime;
+#endif
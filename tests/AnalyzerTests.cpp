@@ -0,0 +1,475 @@
+#include "pch.h"
+#include "../lovela/Analyzer.h"
+
+using namespace boost::ut;
+
+namespace
+{
+	struct Analyzed
+	{
+		std::vector<Node> nodes;
+		std::vector<std::string> errors;
+	};
+
+	Analyzed Analyze(std::string_view code, bool inferTypes = false)
+	{
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		Analyzed result;
+		code >> lexer >> tokens >> parser >> result.nodes;
+
+		Analyzer analyzer;
+		analyzer.options.inferTypes = inferTypes;
+		analyzer.Analyze(result.nodes);
+		result.errors = analyzer.GetErrors();
+
+		for (auto& error : result.errors)
+			std::cerr << error << '\n';
+
+		return result;
+	}
+
+	const Node* FindNode(const std::vector<Node>& nodes, Node::Type type, std::string_view value)
+	{
+		const Node* found{};
+
+		for (auto& node : nodes)
+		{
+			Traverse<const Node>::DepthFirstPreorder(node, [&](const Node& n)
+				{
+					if (!found && n.type == type && n.value == value)
+						found = &n;
+				});
+		}
+
+		return found;
+	}
+}
+
+suite analyzer_callee_tests = [] {
+	"callee is resolved"_test = [] {
+		const auto result = Analyze("f: 1. : f.");
+		expect(result.errors.empty());
+
+		const auto declaration = FindNode(result.nodes, Node::Type::FunctionDeclaration, "f");
+		const auto call = FindNode(result.nodes, Node::Type::FunctionCall, "f");
+		expect(declaration && call);
+		expect(declaration->callee != nullptr);
+		expect(call->callee == declaration->callee);
+	};
+
+	"call before declaration"_test = [] {
+		const auto result = Analyze(": f. f: 1.");
+		expect(result.errors.empty());
+	};
+
+	"forward declaration shares the declaration"_test = [] {
+		const auto result = Analyze("f. f: 1. : f.");
+		expect(result.errors.empty());
+		expect(result.nodes[0].callee == result.nodes[1].callee);
+	};
+
+	"undeclared function"_test = [] {
+		const auto result = Analyze(": g.");
+		expect(result.errors.size() == 1_ul);
+	};
+
+	"imported function"_test = [] {
+		const auto result = Analyze("-> 'Standard C' puts. : 'Hello' puts.");
+		expect(result.errors.empty());
+	};
+};
+
+suite analyzer_type_tests = [] {
+	"compatible input"_test = [] {
+		expect(Analyze("[/type/u32] f. : 5 f.").errors.empty());
+		expect(Analyze("[/type/i16] f. : 200 f.").errors.empty());
+		expect(Analyze("[/type/f64] f. : 1.5 f.").errors.empty());
+	};
+
+	"incompatible input"_test = [] {
+		expect(Analyze("[/type/i32] f. : 1.5 f.").errors.size() == 1_ul);
+		expect(Analyze("g [/type/i8]. [/type/u32] f. : g f.").errors.size() == 1_ul);
+		expect(Analyze("[/type/i8] f. : 200 f.").errors.size() == 1_ul);
+	};
+
+	"chained output to input"_test = [] {
+		expect(Analyze("g [/type/f32]. [/type/f64] f. : g f.").errors.empty());
+		expect(Analyze("g [/type/f32]. [/type/i32] f. : g f.").errors.size() == 1_ul);
+	};
+
+	"parameters"_test = [] {
+		expect(Analyze("f (a [/type/i32], b [/type/i32]). : f (1, 2).").errors.empty());
+		expect(Analyze("f (a [/type/i32]). : f (1, 2).").errors.size() == 1_ul);
+		expect(Analyze("f (a [/type/i8]). : f (1000).").errors.size() == 1_ul);
+	};
+
+	"overloads"_test = [] {
+		const auto result = Analyze("[/type/i32] f. [/type/f64] f. : 1.5 f.");
+		expect(result.errors.empty());
+
+		const auto call = FindNode(result.nodes, Node::Type::FunctionCall, "f");
+		expect(call && call->callee == result.nodes[1].callee);
+	};
+
+	"output type"_test = [] {
+		expect(Analyze("g [/type/i32]: 1000.").errors.empty());
+		expect(Analyze("g [/type/i8]: 1000.").errors.size() == 1_ul);
+	};
+
+	"type compatibility"_test = [] {
+		const TypeSpec i8{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 8, .signedType = true} };
+		const TypeSpec u8{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 8} };
+		const TypeSpec i16{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 16, .signedType = true} };
+		const TypeSpec f32{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .floatType = true} };
+		const TypeSpec named{ .kind = TypeSpec::Kind::Named, .name = "thing" };
+		const TypeSpec any{};
+
+		expect(Analyzer::IsCompatible(i8, i16));
+		expect(Analyzer::IsCompatible(u8, i16));
+		expect(!Analyzer::IsCompatible(u8, i8));
+		expect(!Analyzer::IsCompatible(i8, u8));
+		expect(!Analyzer::IsCompatible(i16, i8));
+		expect(Analyzer::IsCompatible(i16, f32));
+		expect(!Analyzer::IsCompatible(f32, i16));
+		expect(!Analyzer::IsCompatible(named, i8));
+		expect(Analyzer::IsCompatible(named, any));
+		expect(Analyzer::IsCompatible(any, named));
+	};
+};
+
+suite analyzer_inference_tests = [] {
+	const TypeSpec i32{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .signedType = true} };
+	const TypeSpec f64{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 64, .floatType = true} };
+
+	"types from calls"_test = [=] {
+		const auto result = Analyze("f: + 1. g (a): a. : 5 f g (5).", true);
+		expect(result.errors.empty());
+		expect(result.nodes[0].inType == i32);
+		expect(result.nodes[0].callee->inType == i32);
+		expect(result.nodes[1].outType == i32);
+	};
+
+	"parameter types from calls"_test = [=] {
+		const auto result = Analyze("f (a, b): a + b. : f (1, 2.5).", true);
+		expect(result.errors.empty());
+		expect(result.nodes[0].parameters[0]->type == i32);
+		expect(result.nodes[0].parameters[1]->type == f64);
+	};
+
+	"same type of all calls"_test = [=] {
+		const auto result = Analyze("f: + 1. : 5 f. g: 6 f.", true);
+		expect(result.errors.empty());
+		expect(result.nodes[0].inType == i32);
+
+		// Declared and literal types are the same.
+		const auto declared = Analyze("f: * 2 + 1. [/type/i32] g [/type/i32]: f. : 5 f.", true);
+		expect(declared.errors.empty());
+		expect(declared.nodes[0].inType.primitive == i32.primitive);
+		expect(declared.nodes[0].outType.primitive == i32.primitive);
+	};
+
+	"different types of calls"_test = [] {
+		// A wider type would convert the values of the other calls.
+		const auto result = Analyze("f: + 1. : 5 f. g: 2.5 f.", true);
+		expect(result.errors.empty());
+		expect(result.nodes[0].inType.Is(TypeSpec::Kind::Any));
+
+		const auto exported = Analyze("inc: + 1. [/type/i64] a [/type/i64]: inc. <- [/type/f64] b [/type/f64]: inc. : 9007199254740993 a.", true);
+		expect(exported.errors.empty());
+		expect(exported.nodes[0].inType.Is(TypeSpec::Kind::Any));
+	};
+
+	"long call chains"_test = [] {
+		// Each function is analyzed again only when its types or the types of its calls are inferred.
+		std::string code = ": 1 f0.";
+		for (int i = 0; i < 200; ++i)
+			code += fmt::format(" f{}: f{}.", i, i + 1);
+		code += " f200: 1.";
+
+		const auto result = Analyze(code, true);
+		expect(result.errors.empty());
+		expect(FindNode(result.nodes, Node::Type::FunctionDeclaration, "f200")->inType == TypeSpec{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .signedType = true} });
+		expect(FindNode(result.nodes, Node::Type::FunctionDeclaration, "f0")->outType == TypeSpec{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .signedType = true} });
+	};
+
+	"types through call chains"_test = [=] {
+		const auto result = Analyze("g (a): a. f (a): g (a). : f (5).", true);
+		expect(result.errors.empty());
+		expect(result.nodes[0].parameters[0]->type == i32);
+		expect(result.nodes[0].outType == i32);
+		expect(result.nodes[1].outType == i32);
+	};
+
+	"forward declarations are inferred too"_test = [=] {
+		const auto result = Analyze("f (a). f (a): a. : f (5).", true);
+		expect(result.errors.empty());
+		expect(result.nodes[0].parameters[0]->type == i32);
+		expect(result.nodes[1].parameters[0]->type == i32);
+		expect(result.nodes[0].outType == i32);
+	};
+
+	"unknown types remain"_test = [] {
+		// Recursive, exported, overloaded and uncalled functions, and calls with unknown types.
+		expect(Analyze("f: f. : 5 f.", true).nodes[0].inType.Is(TypeSpec::Kind::Any));
+		expect(Analyze("<- f: + 1. : 5 f.", true).nodes[0].inType.Is(TypeSpec::Kind::Any));
+		expect(Analyze("f: + 1. [/type/i8] f: + 1. : 5 f.", true).nodes[0].inType.Is(TypeSpec::Kind::Any));
+		expect(Analyze("f: + 1.", true).nodes[0].inType.Is(TypeSpec::Kind::Any));
+		expect(Analyze("f: + 1. g: f. : g.", true).nodes[0].inType.Is(TypeSpec::Kind::Any));
+		expect(Analyze("f: + 1. : 5 f.").nodes[0].inType.Is(TypeSpec::Kind::Any));
+	};
+
+	"conflicting calls"_test = [] {
+		const auto result = Analyze("f: + 1. g [/type/u64]. h [/type/i64]. a: g f. b: h f.", true);
+		expect(result.errors.empty());
+		expect(result.nodes[0].inType.Is(TypeSpec::Kind::Any));
+	};
+
+	"no templates in generated code"_test = [] {
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		"f (a): + a. : 5 f (2)." >> lexer >> tokens >> parser >> nodes;
+
+		Analyzer analyzer;
+		analyzer.Analyze(nodes);
+		expect(analyzer.GetErrors().empty());
+
+		VectorCoderCpp coder;
+		std::ostringstream output;
+		nodes >> coder >> output;
+
+		expect(output.str().find("template") == std::string::npos) << output.str();
+	};
+};
+
+suite analyzer_reachability_tests = [] {
+	const auto analyze = [](std::string_view code, bool removeUnreachable)
+	{
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		code >> lexer >> tokens >> parser >> nodes;
+
+		Analyzer analyzer;
+		analyzer.options.removeUnreachable = removeUnreachable;
+		analyzer.Analyze(nodes);
+
+		std::vector<std::string> names;
+		for (auto& node : nodes)
+			names.push_back(node.value);
+
+		return std::make_pair(names, analyzer.GetRemovedFunctions());
+	};
+
+	"unreachable functions are removed"_test = [=] {
+		const auto [names, removed] = analyze("-> 'Standard C' puts. -> 'Standard C' abs. h: 1 g. g. g: 1 abs. f: g. <- e: k. k: 3. : f.", true);
+		expect(names == std::vector<std::string>{ "abs", "g", "g", "f", "e", "k", "" });
+		expect(removed == std::vector<std::string>{ "puts", "h" });
+	};
+
+	"recursive functions"_test = [=] {
+		const auto [names, removed] = analyze("f: g. g: f. h: h. : f.", true);
+		expect(names == std::vector<std::string>{ "f", "g", "" });
+		expect(removed == std::vector<std::string>{ "h" });
+	};
+
+	"all functions are kept by default"_test = [=] {
+		const auto [names, removed] = analyze("f: 1. g: 2. : f.", false);
+		expect(names.size() == 3_ul);
+		expect(removed.empty());
+	};
+};
+
+suite analyzer_effects_tests = [] {
+	"effects"_test = [] {
+		const auto result = Analyze("-> 'Standard C' abs. add: + 1. twice: add add. absolute: abs. loop: + 1 loop. mixed: twice absolute. "
+			"outside. inside: outside. undeclared: nowhere. : 1 twice.");
+
+		const auto effects = [&](std::string_view name)
+		{
+			return FindNode(result.nodes, Node::Type::FunctionDeclaration, name)->callee->effects.flags;
+		};
+
+		expect(effects("add") == Effects::None);
+		expect(effects("twice") == Effects::None);
+		expect(effects("loop") == Effects::None);
+		expect(effects("abs") == Effects::Import);
+		expect(effects("absolute") == Effects::Import);
+		expect(effects("mixed") == Effects::Import);
+		expect(effects("outside") == Effects::Unknown);
+		expect(effects("inside") == Effects::Unknown);
+		expect(effects("undeclared") == Effects::Unknown);
+		expect(effects("") == Effects::Context);
+	};
+
+	"effects through long call chains"_test = [] {
+		// The effects are passed on from each function to its callers once.
+		std::string code = ": f0. outside.";
+		for (int i = 0; i < 2000; ++i)
+			code += fmt::format(" f{}: f{}.", i, i + 1);
+		code += " f2000: outside.";
+
+		const auto result = Analyze(code);
+		expect(FindNode(result.nodes, Node::Type::FunctionDeclaration, "f0")->callee->effects.flags == Effects::Unknown);
+		expect(FindNode(result.nodes, Node::Type::FunctionDeclaration, "f1000")->callee->effects.flags == Effects::Unknown);
+	};
+
+	"context use"_test = [] {
+		// The parser doesn't parse the namespaces of calls yet, so the calls of the standard library are given their namespaces here.
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		"write: print_line. arguments: parameters. narrow: cast. other: print_line. caller: write. : write." >> lexer >> tokens >> parser >> nodes;
+
+		const std::map<std::string, NameSpace> nameSpaces{
+			{ "write", { .parts{ "io" }, .root = true } },
+			{ "arguments", { .parts{ "io" }, .root = true } },
+			{ "narrow", { .parts{ "type" }, .root = true } },
+			{ "other", { .parts{ "util" }, .root = true } },
+		};
+
+		for (auto& node : nodes)
+		{
+			if (!nameSpaces.contains(node.value))
+				continue;
+
+			Traverse<Node>::DepthFirstPreorder(node, [&](Node& n)
+				{
+					if (n.type == Node::Type::FunctionCall)
+						n.nameSpace = nameSpaces.at(node.value);
+				});
+		}
+
+		Analyzer analyzer;
+		analyzer.Analyze(nodes);
+
+		const auto effects = [&](std::string_view name)
+		{
+			return FindNode(nodes, Node::Type::FunctionDeclaration, name)->callee->effects.flags;
+		};
+
+		// Streams, parameters and errors are in the context, and other standard functions are unknown.
+		expect(effects("write") == Effects::Context);
+		expect(effects("arguments") == Effects::Context);
+		expect(effects("narrow") == Effects::Context);
+		expect(effects("other") == Effects::Unknown);
+		expect(effects("caller") == Effects::Context);
+	};
+
+	"functions without the context"_test = [] {
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		"-> 'Standard C' abs. add: + 1. twice: add add. absolute: abs. outside. inside: outside. : 1 twice absolute inside." >> lexer >> tokens >> parser >> nodes;
+
+		Analyzer analyzer;
+		analyzer.options.inferTypes = false;
+		analyzer.Analyze(nodes);
+
+		VectorCoderCpp coder;
+		std::ostringstream output;
+		nodes >> coder >> output;
+
+		// Only pure functions don't take the context.
+		expect(output.str().find("auto f_add(auto&& in)\n{\n  auto& v1 = in;") != std::string::npos) << output.str();
+		expect(output.str().find("f_add(f_add(") != std::string::npos) << output.str();
+		expect(output.str().find("auto f_absolute(lovela::context& context, auto&& in)") != std::string::npos) << output.str();
+		expect(output.str().find("auto f_inside(lovela::context& context, auto&& in)") != std::string::npos) << output.str();
+		expect(output.str().find("f_inside(context, ") != std::string::npos) << output.str();
+		expect(output.str().find("f_twice(1)") != std::string::npos) << output.str();
+	};
+
+	"constant functions"_test = [] {
+		const auto result = Analyze("-> 'Standard C' abs. add: + 1. twice: add add. pair (a): (a, 2.5). loop: + 1 loop. "
+			"absolute: abs. text: 'a'. mixed: twice text. : 1 twice.");
+
+		const auto constant = [&](std::string_view name)
+		{
+			return FindNode(result.nodes, Node::Type::FunctionDeclaration, name)->callee->constant;
+		};
+
+		// Pure arithmetic on literal types can be evaluated at compile time, but recursion, imports and strings can't.
+		expect(constant("add"));
+		expect(constant("twice"));
+		expect(constant("pair"));
+		expect(!constant("loop"));
+		expect(!constant("abs"));
+		expect(!constant("absolute"));
+		expect(!constant("text"));
+		expect(!constant("mixed"));
+		expect(!constant(""));
+	};
+
+	"constants through long call chains"_test = [] {
+		// Each function is checked again only when a function that it calls becomes constant.
+		std::string code = ": f0.";
+		for (int i = 0; i < 2000; ++i)
+			code += fmt::format(" f{}: f{}.", i, i + 1);
+		code += " f2000: 1 + 2.";
+
+		const auto result = Analyze(code);
+		expect(FindNode(result.nodes, Node::Type::FunctionDeclaration, "f0")->callee->constant);
+		expect(FindNode(result.nodes, Node::Type::FunctionDeclaration, "f1000")->callee->constant);
+	};
+};
+
+suite analyzer_thread_pool_tests = [] {
+	"many functions"_test = [] {
+		// Enough functions for all threads of the pool to take part.
+		std::string code;
+		for (int i = 0; i < 1000; ++i)
+			code += fmt::format("f{} [/type/i32]: f{}. ", i, (i + 1) % 1000);
+		code += ": f0 g.";
+
+		Analyzer analyzer;
+		analyzer.options.threadPool = std::make_shared<ThreadPool>(4);
+
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		code >> lexer >> tokens >> parser >> nodes;
+		analyzer.Analyze(nodes);
+
+		// The errors are reported in declaration order, regardless of the thread that found them.
+		expect(analyzer.GetErrors().size() == 1_ul);
+
+		bool resolved = true;
+		for (size_t i = 0; i < 1000; ++i)
+			resolved = resolved && nodes[i].children.front().children.front().callee == nodes[(i + 1) % 1000].callee;
+		expect(resolved);
+	};
+
+	"for each"_test = [] {
+		ThreadPool pool(4);
+		std::vector<int> values(10000);
+		pool.ForEach(values.size(), [&](size_t index) { values[index] = static_cast<int>(index); });
+
+		bool done = true;
+		for (size_t i = 0; i < values.size(); ++i)
+			done = done && values[i] == static_cast<int>(i);
+		expect(done);
+
+		expect(throws([&] { pool.ForEach(10, [](size_t index) { if (index == 5) throw std::runtime_error("error"); }); }));
+	};
+
+	"default pool"_test = [] {
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		"f: 1. : f." >> lexer >> tokens >> parser >> nodes;
+
+		// The pool that the analyzer creates isn't kept in its options.
+		Analyzer analyzer;
+		analyzer.Analyze(nodes);
+		expect(analyzer.GetErrors().empty());
+		expect(!analyzer.options.threadPool);
+	};
+};
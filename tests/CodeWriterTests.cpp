@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "../lovela/CodeWriter.h"
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace boost::ut;
+
+suite code_writer_tests = [] {
+	"formatting"_test = [] {
+		CodeWriter writer;
+		writer << "auto v" << size_t{ 12 } << ' ' << '=' << ' ' << std::string("x") << -3 << ';';
+		expect(writer.GetBuffer() == "auto v12 = x-3;");
+	};
+
+	"indentation"_test = [] {
+		CodeWriter writer;
+		writer << '{';
+		writer.NewLine(2) << "deep";
+		writer.NewLine(1) << "shallow";
+		writer.NewLine() << '}';
+		expect(writer.GetBuffer() == "{\n    deep\n  shallow\n}");
+	};
+
+	"buffered output"_test = [] {
+		std::ostringstream output;
+		CodeWriter writer(output);
+
+		writer << "code";
+		expect(output.str().empty());
+
+		writer.Flush();
+		expect(output.str() == "code");
+		expect(writer.GetBuffer().empty());
+	};
+
+	"file output"_test = [] {
+		const auto path = std::filesystem::temp_directory_path() / "lovela-code-writer-test.txt";
+#ifdef _WIN32
+		int file = -1;
+		_sopen_s(&file, path.string().c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _SH_DENYNO, _S_IREAD | _S_IWRITE);
+#else
+		const int file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+		expect(file >= 0_i);
+
+		{
+			// Written in blocks to the file descriptor, without a stream.
+			CodeWriter writer(file);
+			const std::string line(100, 'x');
+			for (int i = 0; i < 1'000; ++i)
+				writer.NewLine(1) << line;
+
+			writer.Flush();
+			expect(writer.GetSize() == 103'000_u);
+		}
+
+#ifdef _WIN32
+		_close(file);
+#else
+		close(file);
+#endif
+		expect(std::filesystem::file_size(path) == 103'000_u);
+		std::filesystem::remove(path);
+	};
+
+	"large output"_test = [] {
+		std::ostringstream output;
+		CodeWriter writer(output);
+
+		// Written in blocks while generating.
+		const std::string line(100, 'x');
+		for (int i = 0; i < 10'000; ++i)
+			writer.NewLine(1) << line;
+
+		expect(!output.str().empty());
+		expect(writer.GetBuffer().size() < 1'000'000_u);
+
+		writer.Flush();
+		expect(output.str().size() == 1'030'000_u);
+	};
+};
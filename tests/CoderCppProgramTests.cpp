@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "TestingBase.h"
+#include "../lovela/Analyzer.h"
 
 class CoderCppTest : public TestingBase
 {
@@ -20,6 +21,8 @@ public:
 
 		std::string code = R"(
 -> 'Standard C' puts.
+[/type/i32] double [/type/i32]: * 2.
+[/type/i32] quadruple [/type/i32]: double double.
 : 'Hello, World!' puts.
 )";
 		std::cout << "Input code:\n" << color.code << code << color.none << '\n';
@@ -30,7 +33,19 @@ public:
 		std::vector<Node> nodes;
 		VectorCoderCpp coder;
 		std::stringstream output;
-		code >> lexer >> tokens >> parser >> nodes >> coder >> output;
+		code >> lexer >> tokens >> parser >> nodes;
+
+		Analyzer analyzer;
+		analyzer.Analyze(nodes);
+
+		for (auto& error : analyzer.GetErrors())
+		{
+			std::cerr << error << '\n';
+		}
+
+		expect(analyzer.GetErrors().empty());
+
+		nodes >> coder >> output;
 
 		bool parseErrors = false;
 
@@ -61,6 +76,8 @@ public:
 
 		std::ofstream program(R"(..\targets\cpp\program\lovela-program.cpp)");
 		coder.GenerateProgramFile(program);
+		// The program doesn't build unless the constant functions are evaluated at compile time.
+		program << "\nstatic_assert(f_quadruple(3) == 12);\n";
 		program.close();
 
 		std::ofstream imports(R"(..\targets\cpp\program\lovela-imports.h)");
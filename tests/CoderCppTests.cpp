@@ -1,12 +1,13 @@
 #include "pch.h"
 #include "TestingBase.h"
+#include "../lovela/Analyzer.h"
 
 class CoderCppTest : public TestingBase
 {
 public:
-	bool Success(const char* name, std::string_view code, std::string_view cppCode)
+	bool Success(const char* name, std::string_view code, std::string_view cppCode, const CoderCpp::Options& options = {})
 	{
-		return Failure(name, code, cppCode, 0);
+		return Failure(name, code, cppCode, 0, options);
 	}
 
 	bool ImportSuccess(const char* name, std::string_view code, std::string_view cppCode)
@@ -19,20 +20,21 @@ public:
 		return ExportFailure(name, code, cppCode, 0);
 	}
 
-	bool Failure(const char* name, std::string_view code, std::string_view cppCode, int expectedErrors);
+	bool Failure(const char* name, std::string_view code, std::string_view cppCode, int expectedErrors, const CoderCpp::Options& options = {});
 	bool ImportFailure(const char* name, std::string_view code, std::string_view cppCode, int expectedErrors);
 	bool ExportFailure(const char* name, std::string_view code, std::string_view cppCode, int expectedErrors);
 };
 
 static CoderCppTest s_test;
 
-bool CoderCppTest::Failure(const char* name, std::string_view code, std::string_view cppCode, int expectedErrors)
+bool CoderCppTest::Failure(const char* name, std::string_view code, std::string_view cppCode, int expectedErrors, const CoderCpp::Options& options)
 {
 	StringLexer lexer;
 	std::vector<Token> tokens;
 	VectorParser parser;
 	std::vector<Node> nodes;
 	VectorCoderCpp coder;
+	coder.options = options;
 	std::ostringstream output;
 	code >> lexer >> tokens >> parser >> nodes >> coder >> output;
 
@@ -354,7 +356,7 @@ suite CoderCpp_function_tagged_input_type_tests = [] {
 			"[#1] f",
 			R"cpp(
 template <typename Tag1>
-auto f_f(lovela::context& context, Tag1 in);)cpp"
+auto f_f(lovela::context& context, Tag1&& in);)cpp"
 		));
 	};
 };
@@ -363,7 +365,7 @@ suite CoderCpp_function_literal_output_type_tests = [] {
 	"[1] output"_test = [] {
 		expect(s_test.Success("[1] output",
 			"f [1]",
-			R"cpp(l_i8 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(l_i8 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 };
@@ -372,7 +374,7 @@ suite CoderCpp_function_builtin_output_type_tests = [] {
 	"l_i1 output error"_test = [] {
 		expect(s_test.Failure("l_i1 output error",
 			"f [/type/i1]",
-			R"cpp(InvalidTypeName f_f(lovela::context& context, auto in);)cpp",
+			R"cpp(InvalidTypeName f_f(lovela::context& context, auto&& in);)cpp",
 			1
 		));
 	};
@@ -380,35 +382,35 @@ suite CoderCpp_function_builtin_output_type_tests = [] {
 	"l_i8 output"_test = [] {
 		expect(s_test.Success("l_i8 output",
 			"f [/type/i8]",
-			R"cpp(l_i8 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(l_i8 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 
 	"l_i16 output"_test = [] {
 		expect(s_test.Success("l_i16 output",
 			"f [/type/i16]",
-			R"cpp(l_i16 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(l_i16 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 
 	"l_i32 output"_test = [] {
 		expect(s_test.Success("l_i32 output",
 			"f [/type/i32]",
-			R"cpp(l_i32 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(l_i32 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 
 	"l_i64 output"_test = [] {
 		expect(s_test.Success("l_i64 output",
 			"f [/type/i64]",
-			R"cpp(l_i64 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(l_i64 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 
 	"l_i2 output error"_test = [] {
 		expect(s_test.Failure("l_i2 output error",
 			"f [/type/i2]",
-			R"cpp(InvalidTypeName f_f(lovela::context& context, auto in);)cpp",
+			R"cpp(InvalidTypeName f_f(lovela::context& context, auto&& in);)cpp",
 			1
 		));
 	};
@@ -416,7 +418,7 @@ suite CoderCpp_function_builtin_output_type_tests = [] {
 	"l_u1 output error"_test = [] {
 		expect(s_test.Failure("l_u1 output error",
 			"f [/type/u1]",
-			R"cpp(InvalidTypeName f_f(lovela::context& context, auto in);)cpp",
+			R"cpp(InvalidTypeName f_f(lovela::context& context, auto&& in);)cpp",
 			1
 		));
 	};
@@ -424,35 +426,35 @@ suite CoderCpp_function_builtin_output_type_tests = [] {
 	"l_u8 output"_test = [] {
 		expect(s_test.Success("l_u8 output",
 			"f [/type/u8]",
-			R"cpp(l_u8 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(l_u8 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 
 	"l_u16 output"_test = [] {
 		expect(s_test.Success("l_u16 output",
 			"f [/type/u16]",
-			R"cpp(l_u16 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(l_u16 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 
 	"l_u32 output"_test = [] {
 		expect(s_test.Success("l_u32 output",
 			"f [/type/u32]",
-			R"cpp(l_u32 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(l_u32 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 
 	"l_u64 output"_test = [] {
 		expect(s_test.Success("l_u64 output",
 			"f [/type/u64]",
-			R"cpp(l_u64 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(l_u64 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 
 	"l_f16 output error"_test = [] {
 		expect(s_test.Failure("l_f16 output error",
 			"f [/type/f16]",
-			R"cpp(InvalidTypeName f_f(lovela::context& context, auto in);)cpp",
+			R"cpp(InvalidTypeName f_f(lovela::context& context, auto&& in);)cpp",
 			1
 		));
 	};
@@ -460,14 +462,14 @@ suite CoderCpp_function_builtin_output_type_tests = [] {
 	"l_f32 output"_test = [] {
 		expect(s_test.Success("l_f32 output",
 			"f [/type/f32]",
-			R"cpp(l_f32 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(l_f32 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 
 	"l_f64 output"_test = [] {
 		expect(s_test.Success("l_f64 output",
 			"f [/type/f64]",
-			R"cpp(l_f64 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(l_f64 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 };
@@ -476,7 +478,7 @@ suite CoderCpp_function_tagged_output_type_tests = [] {
 	"[#1] output"_test = [] {
 		expect(s_test.Success("[#1] output",
 			"f [#1]",
-			R"cpp(template <typename Tag1> Tag1 f_f(lovela::context& context, auto in);)cpp"
+			R"cpp(template <typename Tag1> Tag1 f_f(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 };
@@ -485,7 +487,7 @@ suite CoderCpp_function_literal_param_type_tests = [] {
 	"[1] param"_test = [] {
 		expect(s_test.Success("[1] param",
 			"f ([1])",
-			R"cpp(auto f_f(lovela::context& context, auto in, l_i8 param1);)cpp"
+			R"cpp(auto f_f(lovela::context& context, auto&& in, l_i8 param1);)cpp"
 		));
 	};
 };
@@ -494,7 +496,7 @@ suite CoderCpp_function_builtin_param_type_tests = [] {
 	"l_i1 param error"_test = [] {
 		expect(s_test.Failure("l_i1 param error",
 			"f ([/type/i1])",
-			R"cpp(auto f_f(lovela::context& context, auto in, InvalidTypeName param1);)cpp",
+			R"cpp(auto f_f(lovela::context& context, auto&& in, InvalidTypeName param1);)cpp",
 			1
 		));
 	};
@@ -502,14 +504,14 @@ suite CoderCpp_function_builtin_param_type_tests = [] {
 	"l_i32 param"_test = [] {
 		expect(s_test.Success("l_i32 param",
 			"f ([/type/i32])",
-			R"cpp(auto f_f(lovela::context& context, auto in, l_i32 param1);)cpp"
+			R"cpp(auto f_f(lovela::context& context, auto&& in, l_i32 param1);)cpp"
 		));
 	};
 
 	"l_i2 param error"_test = [] {
 		expect(s_test.Failure("l_i2 param error",
 			"f ([/type/i2])",
-			R"cpp(auto f_f(lovela::context& context, auto in, InvalidTypeName param1);)cpp",
+			R"cpp(auto f_f(lovela::context& context, auto&& in, InvalidTypeName param1);)cpp",
 			1
 		));
 	};
@@ -517,21 +519,21 @@ suite CoderCpp_function_builtin_param_type_tests = [] {
 	"l_u8 param"_test = [] {
 		expect(s_test.Success("l_u8 param",
 			"f ([/type/u8])",
-			R"cpp(auto f_f(lovela::context& context, auto in, l_u8 param1);)cpp"
+			R"cpp(auto f_f(lovela::context& context, auto&& in, l_u8 param1);)cpp"
 		));
 	};
 
 	"l_u64 param"_test = [] {
 		expect(s_test.Success("l_u64 param",
 			"f ([/type/u64])",
-			R"cpp(auto f_f(lovela::context& context, auto in, l_u64 param1);)cpp"
+			R"cpp(auto f_f(lovela::context& context, auto&& in, l_u64 param1);)cpp"
 		));
 	};
 
 	"l_f16 param error"_test = [] {
 		expect(s_test.Failure("l_f16 param error",
 			"f ([/type/f16])",
-			R"cpp(auto f_f(lovela::context& context, auto in, InvalidTypeName param1);)cpp",
+			R"cpp(auto f_f(lovela::context& context, auto&& in, InvalidTypeName param1);)cpp",
 			1
 		));
 	};
@@ -539,7 +541,7 @@ suite CoderCpp_function_builtin_param_type_tests = [] {
 	"l_f32 param"_test = [] {
 		expect(s_test.Success("l_f32 param",
 			"f ([/type/f32])",
-			R"cpp(auto f_f(lovela::context& context, auto in, l_f32 param1);)cpp"
+			R"cpp(auto f_f(lovela::context& context, auto&& in, l_f32 param1);)cpp"
 		));
 	};
 };
@@ -548,28 +550,28 @@ suite CoderCpp_function_tagged_param_type_tests = [] {
 	"[#1] param"_test = [] {
 		expect(s_test.Success("[#1] param",
 			"f ([#1])",
-			R"cpp(template <typename Tag1> auto f_f(lovela::context& context, auto in, Tag1 param1);)cpp"
+			R"cpp(template <typename Tag1> auto f_f(lovela::context& context, auto&& in, Tag1&& param1);)cpp"
 		));
 	};
 
 	"[#1] [#2] param"_test = [] {
 		expect(s_test.Success("[#1] [#2] param",
 			"f ([#1], [#2])",
-			R"cpp(template <typename Tag1, typename Tag2> auto f_f(lovela::context& context, auto in, Tag1 param1, Tag2 param2);)cpp"
+			R"cpp(template <typename Tag1, typename Tag2> auto f_f(lovela::context& context, auto&& in, Tag1&& param1, Tag2&& param2);)cpp"
 		));
 	};
 
 	"[#1] [#second] param"_test = [] {
 		expect(s_test.Success("[#1] [#second] param",
 			"f ([#1], [#second])",
-			R"cpp(template <typename Tag1, typename Tagsecond> auto f_f(lovela::context& context, auto in, Tag1 param1, Tagsecond param2);)cpp"
+			R"cpp(template <typename Tag1, typename Tagsecond> auto f_f(lovela::context& context, auto&& in, Tag1&& param1, Tagsecond&& param2);)cpp"
 		));
 	};
 
 	"[#first] [#second] param"_test = [] {
 		expect(s_test.Success("[#first] [#second] param",
 			"f ([#first], [#second])",
-			R"cpp(template <typename Tagfirst, typename Tagsecond> auto f_f(lovela::context& context, auto in, Tagfirst param1, Tagsecond param2);)cpp"
+			R"cpp(template <typename Tagfirst, typename Tagsecond> auto f_f(lovela::context& context, auto&& in, Tagfirst&& param1, Tagsecond&& param2);)cpp"
 		));
 	};
 };
@@ -578,35 +580,35 @@ suite CoderCpp_function_declaration_tests = [] {
 	"trivial function"_test = [] { 
 		expect(s_test.Success("trivial function", 
 			"func",
-			R"cpp(auto f_func(lovela::context& context, auto in);)cpp"
+			R"cpp(auto f_func(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 
 	"function with return type"_test = [] { 
 		expect(s_test.Success("function with return type", 
 			"func [type]",
-			R"cpp(t_type f_func(lovela::context& context, auto in);)cpp"
+			R"cpp(t_type f_func(lovela::context& context, auto&& in);)cpp"
 		));
 	};
 
 	"function with object type"_test = [] { 
 		expect(s_test.Success("function with object type", 
 			"[type] func",
-			R"cpp(auto f_func(lovela::context& context, t_type in);)cpp"
+			R"cpp(auto f_func(lovela::context& context, lovela::param_t<t_type> in);)cpp"
 		));
 	};
 
 	"function with untyped parameter"_test = [] { 
 		expect(s_test.Success("function with untyped parameter", 
 			"func (arg)",
-			R"cpp(auto f_func(lovela::context& context, auto in, auto p_arg);)cpp"
+			R"cpp(auto f_func(lovela::context& context, auto&& in, auto&& p_arg);)cpp"
 		));
 	};
 
 	"function with typed parameter"_test = [] { 
 		expect(s_test.Success("function with typed parameter", 
 			"func (arg [type])",
-			R"cpp(auto f_func(lovela::context& context, auto in, t_type p_arg);)cpp"
+			R"cpp(auto f_func(lovela::context& context, auto&& in, lovela::param_t<t_type> p_arg);)cpp"
 		));
 	};
 
@@ -614,11 +616,49 @@ suite CoderCpp_function_declaration_tests = [] {
 		expect(s_test.Success("increment function", 
 			"func: + 1.", 
 			R"cpp(
-auto f_func(lovela::context& context, auto in)
+auto f_func(lovela::context& context, auto&& in)
 {
 	static_cast<void>(context);
 	auto& v1 = in; static_cast<void>(v1);
-	const auto v2 = v1 + 1; static_cast<void>(v2);
+	auto v2 = v1 + 1; static_cast<void>(v2);
+	return v2;
+}
+)cpp"
+		));
+	};
+};
+
+suite CoderCpp_calling_convention_tests = [] {
+	"small types by value"_test = [] {
+		expect(s_test.Success("small types by value",
+			"[/type/i64] f (a [/type/f64], b [/type/i8]#)",
+			R"cpp(auto f_f(lovela::context& context, l_i64 in, l_f64 p_a, l_cstr p_b);)cpp"
+		));
+	};
+
+	"identity function returns by reference"_test = [] {
+		expect(s_test.Success("identity function returns by reference",
+			"[type] f [type]: .",
+			R"cpp(
+lovela::param_t<t_type> f_f(lovela::context& context, lovela::param_t<t_type> in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	return std::forward<decltype(in)>(v1);
+}
+)cpp"
+		));
+	};
+
+	"changed value returns by value"_test = [] {
+		expect(s_test.Success("changed value returns by value",
+			"f: + 1.",
+			R"cpp(
+auto f_f(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = v1 + 1; static_cast<void>(v2);
 	return v2;
 }
 )cpp"
@@ -635,7 +675,7 @@ l_i8 f_func(lovela::context& context, l_i8 in)
 {
 	static_cast<void>(context);
 	auto& v1 = in; static_cast<void>(v1);
-	const auto v2 = f_f(context, v1, 123); static_cast<void>(v2);
+	auto v2 = f_f(context, std::forward<decltype(in)>(v1), 123); static_cast<void>(v2);
 	return v2;
 }
 )cpp"
@@ -650,7 +690,7 @@ l_i8 f_func(lovela::context& context, l_i8 in)
 {
 	static_cast<void>(context);
 	auto& v1 = in; static_cast<void>(v1);
-	const auto v2 = f_f(context, v1, 1, "a", f_g(context, v1)); static_cast<void>(v2);
+	auto v2 = f_f(context, v1, 1, "a", f_g(context, v1)); static_cast<void>(v2);
 	return v2;
 }
 )cpp"
@@ -684,11 +724,11 @@ void ex()
 		expect(s_test.Success("exported function any -> any",
 			"<- ex: + 1.",
 			R"cpp(
-auto f_ex(lovela::context& context, auto in)
+auto f_ex(lovela::context& context, auto&& in)
 {
 	static_cast<void>(context);
 	auto& v1 = in; static_cast<void>(v1);
-	const auto v2 = v1 + 1; static_cast<void>(v2);
+	auto v2 = v1 + 1; static_cast<void>(v2);
 	return v2;
 }
 
@@ -730,7 +770,7 @@ suite CoderCpp_imported_functions_tests = [] {
 		expect(s_test.Success("imported function",
 			"-> im",
 			R"cpp(
-auto f_im(lovela::context& context, auto in)
+auto f_im(lovela::context& context, auto&& in)
 {
 	static_cast<void>(context); return im(in);
 }
@@ -834,7 +874,7 @@ l_i32 f_ex(lovela::context& context, l_i32 in)
 {
 	static_cast<void>(context);
 	auto& v1 = in; static_cast<void>(v1);
-	const auto v2 = v1 + 1; static_cast<void>(v2);
+	auto v2 = v1 + 1; static_cast<void>(v2);
 	return v2;
 }
 
@@ -848,7 +888,7 @@ lovela::None lovela::main(lovela::context& context, lovela::None in)
 {
 	static_cast<void>(context);
 	auto& v1 = in; static_cast<void>(v1);
-	const auto v2 = f_ex(context, 1); static_cast<void>(v2);
+	auto v2 = f_ex(context, 1); static_cast<void>(v2);
 	return {};
 }
 )cpp"
@@ -869,7 +909,7 @@ lovela::None lovela::main(lovela::context& context, lovela::None in)
 {
 	static_cast<void>(context);
 	auto& v1 = in; static_cast<void>(v1);
-	const auto v2 = f_puts(context, "Hello, Wordl!"); static_cast<void>(v2);
+	auto v2 = f_puts(context, "Hello, Wordl!"); static_cast<void>(v2);
 	return {};
 }
 )cpp"
@@ -880,7 +920,7 @@ lovela::None lovela::main(lovela::context& context, lovela::None in)
 		expect(s_test.Success("main and implicitly typed import", 
 			"-> puts. : 'Hello, Wordl!' puts.", 
 			R"cpp(
-auto f_puts(lovela::context& context, auto in)
+auto f_puts(lovela::context& context, auto&& in)
 {
 	static_cast<void>(context);
 	return puts(in);
@@ -890,7 +930,7 @@ lovela::None lovela::main(lovela::context& context, lovela::None in)
 {
 	static_cast<void>(context);
 	auto& v1 = in; static_cast<void>(v1);
-	const auto v2 = f_puts(context, "Hello, Wordl!"); static_cast<void>(v2);
+	auto v2 = f_puts(context, "Hello, Wordl!"); static_cast<void>(v2);
 	return {};
 }
 )cpp"
@@ -903,16 +943,547 @@ suite CoderCpp_expression_tests = [] {
 		expect(s_test.Success("expression with input",
 			"func: (scale rotate translate).",
 			R"cpp(
-auto f_func(lovela::context& context, auto in)
+auto f_func(lovela::context& context, auto&& in)
 {
 	static_cast<void>(context);
 	auto& v1 = in; static_cast<void>(v1);
-	const auto v2 = f_scale(context, v1); static_cast<void>(v2);
-	const auto v3 = f_rotate(context, v2); static_cast<void>(v3);
-	const auto v4 = f_translate(context, v3); static_cast<void>(v4);
+	auto v2 = f_translate(context, f_rotate(context, f_scale(context, std::forward<decltype(in)>(v1)))); static_cast<void>(v2);
+	return v2;
+}
+)cpp"
+));
+	};
+
+	"expression with named locals"_test = [] {
+		expect(s_test.Success("expression with named locals",
+			"func: (scale rotate translate).",
+			R"cpp(
+auto f_func(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_scale(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	auto v3 = f_rotate(context, std::move(v2)); static_cast<void>(v3);
+	auto v4 = f_translate(context, std::move(v3)); static_cast<void>(v4);
 	return v4;
 }
+)cpp",
+			{ .namedLocals = true }
+));
+	};
+
+	"nested binary operations"_test = [] {
+		expect(s_test.Success("nested binary operations",
+			"func: + 1 * 2 f.",
+			R"cpp(
+auto f_func(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_f(context, ((v1 + 1) * 2)); static_cast<void>(v2);
+	return v2;
+}
 )cpp"
 ));
 	};
+
+	"value used twice"_test = [] {
+		expect(s_test.Success("value used twice",
+			"func: f + (g).",
+			R"cpp(
+auto f_func(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_f(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	auto v3 = v2 + f_g(context, v2); static_cast<void>(v3);
+	return v3;
+}
+)cpp"
+));
+	};
+};
+
+suite CoderCpp_parallel_tests = [] {
+	"parallel code generation"_test = [] {
+		// Functions with errors, imports and exports, so that all outputs of the parts are merged.
+		std::string code;
+		for (int f = 0; f < 100; ++f)
+		{
+			code += fmt::format("-> 'C' <stdio.h> [/type/i32] im{0} [/type/i32]\n", f);
+			code += fmt::format("<- 'C' [/type/i32] ex{0} [/type/i32]: im{0}.\n", f);
+			code += fmt::format("[/type/i1] err{0}\n", f);
+			code += fmt::format("f{0}: f{1} + 1.\n", f, f ? f - 1 : 0);
+		}
+
+		const auto generate = [&](std::shared_ptr<ThreadPool> threadPool)
+		{
+			StringLexer lexer;
+			std::vector<Token> tokens;
+			VectorParser parser;
+			std::vector<Node> nodes;
+			VectorCoderCpp coder;
+			coder.options.threadPool = threadPool;
+			std::ostringstream output;
+			std::string_view{ code } >> lexer >> tokens >> parser >> nodes >> coder >> output;
+			return std::tuple{ output.str(), coder.GetImports(), coder.GetExports(), coder.GetErrors() };
+		};
+
+		const auto serial = generate({});
+		const auto parallel = generate(std::make_shared<ThreadPool>(4));
+
+		expect(std::get<0>(parallel) == std::get<0>(serial));
+		expect(std::get<1>(parallel) == std::get<1>(serial));
+		expect(std::get<2>(parallel) == std::get<2>(serial));
+		expect(std::get<3>(parallel) == std::get<3>(serial));
+		expect(std::get<2>(serial).size() == 100_u);
+		expect(std::get<3>(serial).size() == 100_u);
+	};
+};
+
+suite CoderCpp_split_program_tests = [] {
+	"split program"_test = [] {
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		VectorCoderCpp coder;
+		// The program is read back from the stream.
+		std::stringstream output;
+		std::string_view{ R"(
+[/type/i32] a [/type/i32]: b.
+[/type/i32] b [/type/i32]: + 1.
+c: a.
+<- 'C' [/type/i32] ex [/type/i32]: a.
+)" } >> lexer >> tokens >> parser >> nodes >> coder >> output;
+
+		const auto files = coder.SplitProgram(2);
+		expect(files.size() == 3_u);
+
+		auto& header = files[0];
+		auto& source1 = files[1];
+		auto& source2 = files[2];
+
+		// All functions are declared first, so that the definitions can be in any order.
+		expect(header.find("\nl_i32 f_a(lovela::context& context, l_i32 in);") < header.find("\nl_i32 f_b(lovela::context& context, l_i32 in);"));
+		expect(header.find("\ninline auto f_c(lovela::context& context, auto&& in);") < header.find("\nauto f_c(lovela::context& context, auto&& in)\n{"));
+		expect(header.find("l_i32 f_a(lovela::context& context, l_i32 in)\n{") == std::string::npos);
+		expect(header.find("l_i32 ex(l_i32 in)") == std::string::npos);
+
+		// The definitions that aren't shared are in the source files, in order.
+		const auto sources = source1 + source2;
+		expect(source1.starts_with("\n#include \"lovela-program-declarations.h\"\n"));
+		expect(source2.starts_with("\n#include \"lovela-program-declarations.h\"\n"));
+		expect(sources.find("l_i32 f_a(lovela::context& context, l_i32 in)\n{") < sources.find("l_i32 f_b(lovela::context& context, l_i32 in)\n{"));
+		expect(sources.find("l_i32 f_b(lovela::context& context, l_i32 in)\n{") < sources.find("l_i32 ex(l_i32 in)\n{"));
+		expect(sources.find("f_c(lovela::context& context, auto&& in)\n{") == std::string::npos);
+
+		// Splitting again gives the same files.
+		expect(coder.SplitProgram(2) == files);
+	};
+};
+
+suite CoderCpp_runtime_tests = [] {
+	"runtime include"_test = [] {
+		const auto generate = [](CoderCpp::Runtime runtime)
+		{
+			StringLexer lexer;
+			std::vector<Token> tokens;
+			VectorParser parser;
+			std::vector<Node> nodes;
+			VectorCoderCpp coder;
+			coder.options.runtime = runtime;
+			std::stringstream output;
+			std::string_view{ "[/type/i32] f [/type/i32]: + 1." } >> lexer >> tokens >> parser >> nodes >> coder >> output;
+
+			std::ostringstream program;
+			coder.GenerateProgramFile(program);
+			return std::pair{ program.str(), coder.SplitProgram(1).back() };
+		};
+
+		const auto header = generate(CoderCpp::Runtime::Header);
+		expect(header.first.starts_with("\n#include \"lovela-program.h\"\n"));
+		expect(header.second.starts_with("\n#include \"lovela-program-declarations.h\"\n"));
+
+		// The precompiled header must be the first include.
+		const auto precompiledHeader = generate(CoderCpp::Runtime::PrecompiledHeader);
+		expect(precompiledHeader.first.starts_with("\n#include \"lovela-runtime-pch.h\"\n#include \"lovela-program.h\"\n"));
+		expect(precompiledHeader.second.starts_with("\n#include \"lovela-runtime-pch.h\"\n#include \"lovela-program-declarations.h\"\n"));
+
+		const auto module = generate(CoderCpp::Runtime::Module);
+		expect(module.first.starts_with("\n#define LOVELA_RUNTIME_MODULE\n#include \"lovela-program.h\"\n"));
+		expect(module.second.starts_with("\n#define LOVELA_RUNTIME_MODULE\n#include \"lovela-program-declarations.h\"\n"));
+
+		// The code is the same.
+		expect(header.first.substr(header.first.find("l_i32 f_f")) == module.first.substr(module.first.find("l_i32 f_f")));
+	};
+};
+
+suite CoderCpp_source_mapping_tests = [] {
+	"line directives"_test = [] {
+		expect(s_test.Success("line directives",
+			"[/type/i32] f [/type/i32]:\n  + 1 * 2.",
+			R"cpp(
+#line 1 "src\\main.lovela"
+l_i32 f_f(lovela::context& context, l_i32 in)
+{
+  static_cast<void>(context);
+  auto& v1 = in; static_cast<void>(v1);
+#line 2 "src\\main.lovela"
+  auto v2 = (v1 + 1) * 2; static_cast<void>(v2);
+  return v2;
+}
+)cpp", { .sourceFile = "src\\main.lovela" }));
+	};
+
+	"perf map"_test = [] {
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		std::string_view{ "[/type/i32] f [/type/i32]: + 1.\ng: f.\n: 1 g." } >> lexer >> tokens >> parser >> nodes;
+
+		// Undefined symbols, symbols without size or code, and malformed lines are skipped.
+		std::istringstream symbols(R"(
+                 U puts
+0000000000001139 000000000000002b T f_f(lovela::context&, int)
+0000000000001164 0000000000000010 W auto f_g<int>(lovela::context&, int&&)
+0000000000001174 0000000000000010 W auto f_g<std::pair<int, int> >(lovela::context&, std::pair<int, int>&&)
+0000000000001184 0000000000000020 T lovela::main(lovela::context&, lovela::None)
+0000000000004010 B f_counter
+0000000000004020 T f_f(lovela::context&, int)
+00000000000011zz 0000000000000010 T f_f(lovela::context&, int)
+0000000000001194 10 T f_f(lovela::context&, int)
+0000000000001194 0000000000000000 T f_f(lovela::context&, int)
+0000000000001194
+)");
+		std::ostringstream perfMap;
+		CoderCpp::GeneratePerfMap(symbols, perfMap, nodes, 0x10000);
+
+		expect(perfMap.str() == R"(11139 000000000000002b f
+11164 0000000000000010 g<int>
+11174 0000000000000010 g<std::pair<int, int> >
+)") << perfMap.str();
+	};
+};
+
+suite CoderCpp_throughput_tests = [] {
+	// A benchmark, which is skipped unless the tests are run with the benchmark tag as argument.
+	tag("benchmark") / "million node syntax tree"_test = [] {
+		// 10,000 functions with 50 chained function calls each.
+		std::vector<Node> nodes;
+
+		for (int f = 0; f < 10'000; ++f)
+		{
+			Node expression{ .type = Node::Type::Expression };
+
+			for (int c = 0; c < 50; ++c)
+			{
+				Node input{ .type = c ? Node::Type::ExpressionInput : Node::Type::Literal, .value = c ? "" : "1" };
+				input.token.type = c ? Token::Type::Empty : Token::Type::LiteralInteger;
+
+				Node call{ .type = Node::Type::FunctionCall, .value = "g" };
+				call.children.push_back(std::move(input));
+				expression.children.push_back(std::move(call));
+			}
+
+			Node function{ .type = Node::Type::FunctionDeclaration, .value = fmt::format("f{}", f) };
+			function.children.push_back(std::move(expression));
+			nodes.push_back(std::move(function));
+		}
+
+		size_t count = 0;
+		for (auto& node : nodes)
+			Traverse<Node>::DepthFirstPreorder(node, [&](Node&) { ++count; });
+
+		VectorCoderCpp coder;
+		std::ostringstream output;
+
+		const auto start = std::chrono::steady_clock::now();
+		nodes >> coder >> output;
+		const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+		std::cerr << fmt::format("Generated code for {} nodes in {:.3f} s, {:.2f} million nodes per second.\n", count, seconds.count(), count / seconds.count() / 1e6);
+
+		expect(count > 1'000'000_u);
+		expect(coder.GetErrors().empty());
+		expect(output.str().size() > count);
+
+		VectorCoderCpp parallelCoder;
+		parallelCoder.options.threadPool = std::make_shared<ThreadPool>();
+		std::ostringstream parallelOutput;
+
+		const auto parallelStart = std::chrono::steady_clock::now();
+		nodes >> parallelCoder >> parallelOutput;
+		const std::chrono::duration<double> parallelSeconds = std::chrono::steady_clock::now() - parallelStart;
+
+		std::cerr << fmt::format("Generated code for {} nodes on {} threads in {:.3f} s, {:.2f} million nodes per second.\n",
+			count, parallelCoder.options.threadPool->GetThreadCount(), parallelSeconds.count(), count / parallelSeconds.count() / 1e6);
+
+		expect(parallelOutput.str() == output.str());
+	};
+};
+
+suite CoderCpp_profile_tests = [] {
+	"profiled function"_test = [] {
+		expect(s_test.Success("profiled function",
+			"[/type/i32] f [/type/i32]: + 1.",
+			R"cpp(
+l_i32 f_f(lovela::context& context, l_i32 in)
+{
+  static_cast<void>(context);
+  static const lovela::profiler::function profiler_function{ "f" };
+  const lovela::profiler::scope profiler_scope{ profiler_function };
+  auto& v1 = in; static_cast<void>(v1);
+  auto v2 = v1 + 1; static_cast<void>(v2);
+  return v2;
+}
+)cpp", { .profile = true }));
+	};
+};
+
+suite CoderCpp_profile_use_tests = [] {
+	"hot and cold functions"_test = [] {
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		VectorCoderCpp coder;
+		auto profile = std::make_shared<Profile>();
+		std::istringstream report("1\t0\t0\tmain\n1\t0\t0\ta\n1000\t0\t0\tb\n5\t0\t0\tc\n");
+		profile->Read(report);
+		coder.options.profileUse = profile;
+		std::stringstream output;
+		std::string_view{ R"(
+[/type/i32] a [/type/i32]: b.
+[/type/i32] b [/type/i32]: + 1.
+c: a.
+[/type/i32] d [/type/i32]: + 2.
+: 1 c.
+)" } >> lexer >> tokens >> parser >> nodes >> coder >> output;
+
+		// The hot function b and the cold function d are annotated, also in the declarations of a split program.
+		expect(output.str().find("\nl_i32 f_a(lovela::context& context, l_i32 in)\n{") != std::string::npos) << output.str();
+		expect(output.str().find("\nLOVELA_HOT l_i32 f_b(lovela::context& context, l_i32 in)\n{") != std::string::npos) << output.str();
+		expect(output.str().find("\nauto f_c(lovela::context& context, auto&& in)\n{") != std::string::npos) << output.str();
+		expect(output.str().find("\nLOVELA_COLD l_i32 f_d(lovela::context& context, l_i32 in)\n{") != std::string::npos) << output.str();
+
+		const auto files = coder.SplitProgram(1);
+		expect(files.size() == 2_u);
+		expect(files[0].find("\nLOVELA_HOT l_i32 f_b(lovela::context& context, l_i32 in);") != std::string::npos) << files[0];
+		expect(files[0].find("\nLOVELA_COLD l_i32 f_d(lovela::context& context, l_i32 in);") != std::string::npos) << files[0];
+
+		// The most called functions are defined first in the source files.
+		auto& source = files[1];
+		expect(source.find("f_b(lovela::context& context, l_i32 in)\n{") < source.find("lovela::main(lovela::context& context, lovela::None in)\n{")) << source;
+		expect(source.find("lovela::main(lovela::context& context, lovela::None in)\n{") < source.find("f_d(lovela::context& context, l_i32 in)\n{")) << source;
+		expect(source.find("f_a(lovela::context& context, l_i32 in)\n{") < source.find("f_d(lovela::context& context, l_i32 in)\n{")) << source;
+	};
+};
+
+suite CoderCpp_deduplication_tests = [] {
+	"identical functions"_test = [] {
+		// The functions only differ in their names and positions, but parameter names are part of the code.
+		expect(s_test.Success("identical functions",
+			"[/type/i32] a [/type/i32]: + 1 f.\n[/type/i32] bb [/type/i32]:  + 1 f.\nc (x): + x.\nd (x): + x.\ne (y): + y.",
+			R"cpp(
+l_i32 f_a(lovela::context& context, l_i32 in)
+{
+  static_cast<void>(context);
+  auto& v1 = in; static_cast<void>(v1);
+  auto v2 = f_f(context, (v1 + 1)); static_cast<void>(v2);
+  return v2;
+}
+
+l_i32 f_bb(lovela::context& context, l_i32 in)
+{
+  return f_a(context, in);
+}
+
+auto f_c(lovela::context& context, auto&& in, auto&& p_x)
+{
+  static_cast<void>(context);
+  auto& v1 = in; static_cast<void>(v1);
+  auto v2 = v1 + p_x; static_cast<void>(v2);
+  return v2;
+}
+
+auto f_d(lovela::context& context, auto&& in, auto&& p_x)
+{
+  return f_c(context, std::forward<decltype(in)>(in), std::forward<decltype(p_x)>(p_x));
+}
+
+auto f_e(lovela::context& context, auto&& in, auto&& p_y)
+{
+  static_cast<void>(context);
+  auto& v1 = in; static_cast<void>(v1);
+  auto v2 = v1 + p_y; static_cast<void>(v2);
+  return v2;
+}
+)cpp", { .deduplicate = true }));
+	};
+
+	"parallel deduplication"_test = [] {
+		std::string code;
+		for (int f = 0; f < 100; ++f)
+			code += fmt::format("f{0}: + {1}.\n", f, f % 3);
+
+		const auto generate = [&](std::shared_ptr<ThreadPool> threadPool)
+		{
+			StringLexer lexer;
+			std::vector<Token> tokens;
+			VectorParser parser;
+			std::vector<Node> nodes;
+			VectorCoderCpp coder;
+			coder.options.threadPool = threadPool;
+			coder.options.deduplicate = true;
+			std::ostringstream output;
+			std::string_view{ code } >> lexer >> tokens >> parser >> nodes >> coder >> output;
+			return output.str();
+		};
+
+		// The first three functions are the implementations of the others, also when generated in parallel.
+		const auto serial = generate({});
+		expect(serial.find("auto f_f3(lovela::context& context, auto&& in)\n{\n  return f_f0(context, std::forward<decltype(in)>(in));\n}") != std::string::npos) << serial;
+		expect(serial.find("return f_f2(") != std::string::npos) << serial;
+		expect(serial.find("return f_f3(") == std::string::npos) << serial;
+		expect(generate(std::make_shared<ThreadPool>(4)) == serial);
+	};
+};
+
+suite CoderCpp_tail_call_tests = [] {
+	"self tail call"_test = [] {
+		expect(s_test.Success("self tail call",
+			"[/type/i32] countdown [/type/i32]: check - 1 countdown.",
+			R"cpp(
+l_i32 f_countdown(lovela::context& context, l_i32 in)
+{
+  static_cast<void>(context);
+  for (;;)
+  {
+    auto& v1 = in; static_cast<void>(v1);
+    in = l_i32((f_check(context, std::forward<decltype(in)>(v1)) - 1));
+  }
+}
+)cpp"));
+	};
+
+	"self tail call with parameters"_test = [] {
+		expect(s_test.Success("self tail call with parameters",
+			"[/type/i64] sum (step [/type/i64], limit [/type/i64]) [/type/i64]: + step sum (step + 1, limit).",
+			R"cpp(
+l_i64 f_sum(lovela::context& context, l_i64 in, l_i64 p_step, l_i64 p_limit)
+{
+  static_cast<void>(context);
+  for (;;)
+  {
+    auto& v1 = in; static_cast<void>(v1);
+    std::tie(in, p_step, p_limit) = std::tuple<l_i64, l_i64, l_i64>((v1 + p_step), p_step + 1, p_limit);
+  }
+}
+)cpp"));
+	};
+
+	"self tail call with declaration"_test = [] {
+		// The parameters that aren't passed by value are copied to the loop variables, so the signature matches the declaration.
+		expect(s_test.Success("self tail call with declaration",
+			"[type] walk [type]. [type] walk [type]: step walk.",
+			R"cpp(
+t_type f_walk(lovela::context& context, lovela::param_t<t_type> in);
+t_type f_walk(lovela::context& context, lovela::param_t<t_type> in_arg)
+{
+  static_cast<void>(context);
+  t_type in = in_arg;
+  for (;;)
+  {
+    auto& v1 = in; static_cast<void>(v1);
+    in = t_type(f_step(context, std::forward<decltype(in)>(v1)));
+  }
+}
+)cpp"));
+	};
+
+	"tail calls that aren't loops"_test = [] {
+		// The types of function templates may change in each call, and other functions aren't loops.
+		expect(s_test.Success("tail calls that aren't loops",
+			"countdown: - 1 countdown.\n[/type/i32] f [/type/i32]: g.",
+			R"cpp(
+auto f_countdown(lovela::context& context, auto&& in)
+{
+  static_cast<void>(context);
+  auto& v1 = in; static_cast<void>(v1);
+  auto v2 = f_countdown(context, (v1 - 1)); static_cast<void>(v2);
+  return v2;
+}
+
+l_i32 f_f(lovela::context& context, l_i32 in)
+{
+  static_cast<void>(context);
+  auto& v1 = in; static_cast<void>(v1);
+  auto v2 = f_g(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+  return v2;
+}
+)cpp"));
+	};
+};
+
+suite CoderCpp_result_tests = [] {
+	"errors as results"_test = [] {
+		const auto generate = [](bool results)
+		{
+			StringLexer lexer;
+			std::vector<Token> tokens;
+			VectorParser parser;
+			std::vector<Node> nodes;
+			"[/type/i32] external [/type/i32]. [/type/i32] fails [/type/i32]: outside external. [/type/i32] twice [/type/i32]: fails fails. add (a): + a. [/type/i32] nested [/type/i32]: add(fails). "
+				"any: fails + 0.5. <- [/type/i32] exported [/type/i32]: fails. : 4 twice." >> lexer >> tokens >> parser >> nodes;
+
+			Analyzer analyzer;
+			analyzer.Analyze(nodes);
+
+			VectorCoderCpp coder;
+			coder.options.results = results;
+			std::stringstream output;
+			nodes >> coder >> output;
+
+			std::ostringstream program;
+			coder.GenerateProgramFile(program);
+			return program.str();
+		};
+
+		const auto program = generate(true);
+		expect(program.starts_with("\n#include \"lovela-result.h\"\n#include \"lovela-program.h\"\n")) << program;
+
+		// The functions that may fail return their errors, and the callers pass them on before the values are used.
+		expect(program.find("lovela::result<l_i32> f_fails(lovela::context& context, l_i32 in)") != std::string::npos) << program;
+		expect(program.find("auto r1 = f_fails(context, std::forward<decltype(in)>(v1)); if (!r1) { return lovela::fail(r1.error()); }\n"
+			"  auto v2 = *std::move(r1); static_cast<void>(v2);\n"
+			"  auto r2 = f_fails(context, std::move(v2)); if (!r2) { return lovela::fail(r2.error()); }\n") != std::string::npos) << program;
+
+		// Calls that may fail in the arguments are checked before the call.
+		expect(program.find("auto r1 = f_fails(context, v1); if (!r1) { return lovela::fail(r1.error()); }\n"
+			"  auto v2 = f_add(v1, *std::move(r1));") != std::string::npos) << program;
+
+		// The functions that the program doesn't define return plain values, and the errors that they throw are returned at the call.
+		expect(program.find("l_i32 f_external(lovela::context& context, l_i32 in);") != std::string::npos) << program;
+		expect(program.find("auto r1 = lovela::attempt([&] { return f_outside(context, std::forward<decltype(in)>(v1)); }); if (!r1) { return lovela::fail(r1.error()); }\n"
+			"  auto v2 = *std::move(r1); static_cast<void>(v2);\n"
+			"  auto r2 = lovela::attempt([&] { return f_external(context, std::move(v2)); }); if (!r2) { return lovela::fail(r2.error()); }\n") != std::string::npos) << program;
+
+		// Pure functions can't fail.
+		expect(program.find("constexpr l_i32 f_add(l_i32 in, l_i32 p_a)") != std::string::npos) << program;
+
+		// A function whose out type isn't known throws the error, as does an exported function, which returns no result,
+		// and main sets the error in the context.
+		expect(program.find("auto f_any(lovela::context& context, auto&& in)") != std::string::npos) << program;
+		expect(program.find("if (!r1) { throw lovela::error(r1.error().message(), r1.error().code()); }") != std::string::npos) << program;
+		expect(program.find("  const auto result = f_exported(context, in);\n"
+			"  if (!result) { throw lovela::error(result.error().message(), result.error().code()); }\n"
+			"  return *result;") != std::string::npos) << program;
+		expect(program.find("if (!r1) { context.error = lovela::error(r1.error().message(), r1.error().code()); return {}; }") != std::string::npos) << program;
+
+		const auto exceptions = generate(false);
+		expect(exceptions.find("lovela-result.h") == std::string::npos) << exceptions;
+		expect(exceptions.find("lovela::result") == std::string::npos) << exceptions;
+	};
 };
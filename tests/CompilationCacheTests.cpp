@@ -0,0 +1,202 @@
+#include "pch.h"
+#include "../lovela/NodeSerializer.h"
+
+using namespace boost::ut;
+
+namespace
+{
+	// A cache directory that is removed when the test ends.
+	struct TemporaryDirectory
+	{
+		std::filesystem::path path;
+
+		TemporaryDirectory(std::string_view name)
+			: path(std::filesystem::temp_directory_path() / fmt::format("lovela-tests-{}", name))
+		{
+			std::filesystem::remove_all(path);
+		}
+
+		~TemporaryDirectory()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(path, error);
+		}
+	};
+
+	// Prints the syntax tree with tokens, to compare all data of the nodes.
+	std::string PrintTree(const std::vector<Node>& nodes)
+	{
+		std::ostringstream s;
+
+		for (auto& node : nodes)
+		{
+			Traverse<const Node>::DepthFirstPreorder(node, [&](const Node& n)
+				{
+					n.Print(s);
+					s << '\n';
+				});
+		}
+
+		return s.str();
+	}
+
+	std::vector<Node> Parse(std::string_view code, std::shared_ptr<CompilationCache> cache)
+	{
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		parser.options.cache = cache;
+		std::vector<Node> nodes;
+		code >> lexer >> tokens >> parser >> nodes;
+		return nodes;
+	}
+
+	struct Generated
+	{
+		std::string program;
+		std::vector<std::string> imports;
+		std::vector<std::string> exports;
+		std::vector<std::string> errors;
+	};
+
+	Generated Generate(std::string_view code, std::shared_ptr<CompilationCache> cache)
+	{
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		VectorCoderCpp coder;
+		coder.options.cache = cache;
+		std::ostringstream output;
+		code >> lexer >> tokens >> parser >> nodes >> coder >> output;
+		return { output.str(), coder.GetImports(), coder.GetExports(), coder.GetErrors() };
+	}
+
+	constexpr std::string_view program = R"(
+-> 'Standard C' puts.
+<- [#32] square (a [#32]): a * a.
+<< comment >>
+double (a [#32]) [#32]: a + a.
+bad: ( 1 + .
+: 'Hello' puts.
+)";
+}
+
+suite msgpack_tests = [] {
+	"integers round-trip"_test = [] {
+		constexpr std::array<int64_t, 17> values{ 0, 1, 127, 128, 255, 256, 65535, 65536, 4294967295, 4294967296, -1, -32, -33, -128, -129, -32769, std::numeric_limits<int64_t>::min() };
+
+		std::string data;
+		MsgPackWriter writer(data);
+		for (auto value : values)
+			writer.WriteInt(value);
+		writer.WriteUInt(std::numeric_limits<uint64_t>::max());
+
+		MsgPackReader reader(data);
+		for (auto value : values)
+			expect(reader.ReadInt() == value);
+		expect(reader.ReadUInt() == std::numeric_limits<uint64_t>::max());
+		expect(reader.IsDone());
+	};
+
+	"strings and arrays round-trip"_test = [] {
+		const std::vector<std::string> values{ "", "a", std::string(31, 'b'), std::string(32, 'c'), std::string(256, 'd'), std::string(65536, 'e') };
+
+		std::string data;
+		MsgPackWriter writer(data);
+		writer.WriteStringArray(values);
+		writer.WriteNil();
+		writer.WriteBool(true);
+
+		MsgPackReader reader(data);
+		expect(reader.ReadStringArray() == values);
+		expect(reader.ReadNil());
+		expect(reader.ReadBool());
+		expect(reader.IsDone());
+	};
+
+	"malformed data"_test = [] {
+		std::string data;
+		MsgPackWriter writer(data);
+		writer.WriteString("truncated");
+		data.pop_back();
+
+		MsgPackReader reader(data);
+		expect(throws<MsgPackException>([&] { static_cast<void>(reader.ReadString()); }));
+	};
+};
+
+suite node_serializer_tests = [] {
+	"syntax tree round-trip"_test = [] {
+		const auto nodes = Parse(program, {});
+
+		std::string data;
+		MsgPackWriter writer(data);
+		NodeSerializer::Serialize(writer, nodes, 2);
+
+		MsgPackReader reader(data);
+		expect(PrintTree(NodeSerializer::DeserializeNodes(reader, 2)) == PrintTree(nodes));
+		expect(reader.IsDone());
+	};
+
+	"line rebasing"_test = [] {
+		const auto nodes = Parse("f: 1.", {});
+
+		std::string data;
+		MsgPackWriter writer(data);
+		NodeSerializer::Serialize(writer, nodes, 1);
+
+		MsgPackReader reader(data);
+		const auto rebased = NodeSerializer::DeserializeNodes(reader, 10);
+		expect(rebased.size() == 1_ul);
+		expect(rebased.front().token.error.line == 10_ul);
+	};
+};
+
+suite compilation_cache_tests = [] {
+	"parser cache"_test = [] {
+		TemporaryDirectory directory("parser-cache");
+		const auto cache = make<CompilationCache>::shared(CompilationCache(directory.path));
+
+		const auto expected = PrintTree(Parse(program, {}));
+		expect(PrintTree(Parse(program, cache)) == expected) << "cache miss";
+		expect(PrintTree(Parse(program, cache)) == expected) << "cache hit";
+	};
+
+	"parser cache with moved statements"_test = [] {
+		TemporaryDirectory directory("parser-cache-moved");
+		const auto cache = make<CompilationCache>::shared(CompilationCache(directory.path));
+
+		static_cast<void>(Parse(program, cache));
+
+		const auto moved = fmt::format("\n\n{}", program);
+		expect(PrintTree(Parse(moved, cache)) == PrintTree(Parse(moved, {})));
+	};
+
+	"coder cache"_test = [] {
+		TemporaryDirectory directory("coder-cache");
+		const auto cache = make<CompilationCache>::shared(CompilationCache(directory.path));
+
+		const auto expected = Generate(program, {});
+
+		for (auto pass : { "cache miss", "cache hit" })
+		{
+			const auto actual = Generate(program, cache);
+			expect(actual.program == expected.program) << pass;
+			expect(actual.imports == expected.imports) << pass;
+			expect(actual.exports == expected.exports) << pass;
+			expect(actual.errors == expected.errors) << pass;
+		}
+	};
+
+	"write if changed"_test = [] {
+		TemporaryDirectory directory("write-if-changed");
+		std::filesystem::create_directories(directory.path);
+		const auto path = directory.path / "file.txt";
+
+		expect(write_if_changed(path, "abc"));
+		expect(!write_if_changed(path, "abc"));
+		expect(write_if_changed(path, "abd"));
+		expect(write_if_changed(path, "ab"));
+	};
+};
@@ -0,0 +1,115 @@
+#include "pch.h"
+#include "../lovela/Analyzer.h"
+#include "../lovela/ConstantFolder.h"
+
+using namespace boost::ut;
+
+namespace
+{
+	// Returns the body of the last function after the analysis.
+	Node Fold(std::string_view code, bool foldConstants = true)
+	{
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		code >> lexer >> tokens >> parser >> nodes;
+
+		Analyzer analyzer;
+		analyzer.options.foldConstants = foldConstants;
+		analyzer.Analyze(nodes);
+
+		for (auto& error : analyzer.GetErrors())
+			std::cerr << error << '\n';
+
+		if (nodes.empty() || nodes.back().children.empty())
+			return {};
+
+		return nodes.back().children.front();
+	}
+
+	bool IsLiteral(const Node& node, std::string_view value)
+	{
+		return node.type == Node::Type::Literal && node.value == value;
+	}
+
+	std::optional<ConstantFolder::Constant> Apply(std::string_view operation, ConstantFolder::Constant left, ConstantFolder::Constant right)
+	{
+		return ConstantFolder::Apply(operation, left, right);
+	}
+}
+
+suite constant_folder_tests = [] {
+	"integer arithmetic"_test = [] {
+		expect(IsLiteral(Fold(": 1 + 2 * 3."), "9"));
+		expect(IsLiteral(Fold(": 1 - 5."), "-4"));
+		expect(IsLiteral(Fold(": 2 * (3 + 4)."), "14"));
+		expect(IsLiteral(Fold(": 4294967295 * 2."), "8589934590"));
+	};
+
+	"decimal arithmetic"_test = [] {
+		expect(IsLiteral(Fold(": 1.5 * 2.0."), "3.0"));
+		expect(IsLiteral(Fold(": 0.1 + 0.2."), "0.30000000000000004"));
+		expect(IsLiteral(Fold(": 1 + 0.5."), "1.5"));
+		expect(IsLiteral(Fold(": 1.0e200 * 1.0e100."), "1.0e+300"));
+	};
+
+	"literal types"_test = [] {
+		const auto node = Fold(": 100 + 100.");
+		expect(node.outType == TypeSpec{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 8} });
+		expect(node.token.type == Token::Type::LiteralInteger);
+
+		expect(Fold(": 1.5 + 1.5.").outType == TypeSpec{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .floatType = true} });
+	};
+
+	"run time results are kept"_test = [] {
+		// Overflow, infinity, and results that change the C++ type of the literal.
+		expect(Fold(": 2147483647 + 1.").type == Node::Type::Expression);
+		expect(Fold(": 1.0e300 * 1.0e300.").type == Node::Type::Expression);
+		expect(Fold(": 3000000000 - 2999999999.").type == Node::Type::Expression);
+		expect(Fold(": 1 + 2.", false).type == Node::Type::Expression);
+	};
+
+	"partial chain"_test = [] {
+		const auto node = Fold("g. : 1 + 2 g * 3.");
+		expect(node.type == Node::Type::Expression);
+		expect(node.children.size() == 2_ul);
+		expect(IsLiteral(node.children.front().children.front(), "3"));
+
+		// The input in the group of the next operation is also the folded value.
+		const auto group = Fold("g: + 1. [/type/i32] h [/type/i32]: 1 + 2 * (g).");
+		expect(group.children.size() == 1_ul);
+		bool input = false;
+		Traverse<const Node>::DepthFirstPreorder(group, [&](const Node& n) { input = input || n.type == Node::Type::ExpressionInput; });
+		expect(!input);
+		expect(IsLiteral(group.children.front().children.front(), "3"));
+	};
+
+	"math functions"_test = [] {
+		expect(IsLiteral(Fold("-> 'Standard C' sqrt. : 2.0 sqrt."), "1.4142135623730951"));
+		expect(IsLiteral(Fold("-> 'Standard C' floor. : 2.5 floor + 1.0."), "3.0"));
+		expect(IsLiteral(Fold("-> 'Standard C' fmod (y). : 5.5 fmod (2.0)."), "1.5"));
+
+		// Not exact, not double or not Standard C.
+		expect(Fold("-> 'Standard C' sin. : 2.0 sin.").type == Node::Type::Expression);
+		expect(Fold("-> 'Standard C' sqrt. : 4 sqrt.").type == Node::Type::Expression);
+		expect(Fold("-> 'Standard C' [/type/f32] sqrt. : 2.0 sqrt.").type == Node::Type::Expression);
+		expect(Fold("sqrt. : 2.0 sqrt.").type == Node::Type::Expression);
+	};
+
+	"arithmetic conversions"_test = [] {
+		using C = ConstantFolder::Constant;
+
+		expect(Apply("+", C{ 1 }, C{ int64_t{ 2 } }) == C{ int64_t{ 3 } });
+		expect(Apply("-", C{ 0 }, C{ uint64_t{ 1 } }) == C{ std::numeric_limits<uint64_t>::max() });
+		expect(Apply("*", C{ 2 }, C{ 1.5 }) == C{ 3.0 });
+		expect(Apply("/", C{ 7 }, C{ 2 }) == C{ 3 });
+		expect(Apply("/", C{ 7 }, C{ 0 }) == std::nullopt);
+		expect(Apply("/", C{ 1.0 }, C{ 0.0 }) == std::nullopt);
+		expect(Apply("/", C{ std::numeric_limits<int64_t>::min() }, C{ int64_t{ -1 } }) == std::nullopt);
+		expect(Apply("*", C{ std::numeric_limits<int32_t>::min() }, C{ -1 }) == std::nullopt);
+		expect(Apply("*", C{ 65536 }, C{ 32768 }) == std::nullopt);
+		expect(Apply("*", C{ -65536 }, C{ 32768 }) == C{ std::numeric_limits<int32_t>::min() });
+		expect(Apply("<", C{ 1 }, C{ 2 }) == std::nullopt);
+	};
+};
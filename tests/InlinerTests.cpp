@@ -0,0 +1,110 @@
+#include "pch.h"
+#include "../lovela/Analyzer.h"
+
+using namespace boost::ut;
+
+namespace
+{
+	std::vector<Node> Inline(std::string_view code, size_t inlineSize = 16, std::shared_ptr<const Profile> profile = {})
+	{
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		code >> lexer >> tokens >> parser >> nodes;
+
+		Analyzer analyzer;
+		analyzer.options.inlineSize = inlineSize;
+		analyzer.options.foldConstants = false;
+		analyzer.options.profileUse = profile;
+		analyzer.Analyze(nodes);
+
+		for (auto& error : analyzer.GetErrors())
+			std::cerr << error << '\n';
+
+		return nodes;
+	}
+
+	// Prints the body of the last function as (type value children...).
+	std::string PrintBody(const std::vector<Node>& nodes)
+	{
+		std::string s;
+
+		const std::function<void(const Node&)> print = [&](const Node& node)
+		{
+			s += fmt::format("({} {}", to_string(node.type), node.value);
+			for (auto& child : node.children)
+				print(child);
+			s += ')';
+		};
+
+		print(nodes.back().children.front());
+		return s;
+	}
+}
+
+suite inliner_tests = [] {
+	"input chaining"_test = [] {
+		expect(PrintBody(Inline("inc: + 1. : 5 inc inc.")) ==
+			"(Expression (BinaryOperation +(Literal 5)(Literal 1))(BinaryOperation +(ExpressionInput )(Literal 1)))");
+	};
+
+	"parameters"_test = [] {
+		expect(PrintBody(Inline("add (a): + a. f (b): 1 add (b).")) ==
+			"(Expression (BinaryOperation +(Literal 1)(VariableReference b)))");
+		expect(PrintBody(Inline("second (a, b): b. : second (1, 2).")) == "(Literal 2)");
+	};
+
+	"nested functions"_test = [] {
+		expect(PrintBody(Inline("a: + 1. b: a * 2. : 3 b.")) ==
+			"(Expression (BinaryOperation +(Literal 3)(Literal 1))(BinaryOperation *(ExpressionInput )(Literal 2)))");
+	};
+
+	"inlined functions are checked"_test = [] {
+		const auto nodes = Inline("inc: + 1. : 5 inc.");
+		expect(nodes.back().children.front().children.front().outType.Is(TypeSpec::Kind::Any));
+		expect(Inline("[/type/i8] f: 1. g: f. : 1000 g.").back().children.front().children.front().type == Node::Type::FunctionCall);
+	};
+
+	"functions that aren't inlined"_test = [] {
+		// Recursive, typed, too large, and with complex arguments.
+		expect(PrintBody(Inline("f: f. : 1 f.")) == "(Expression (FunctionCall f(Literal 1)))");
+		expect(PrintBody(Inline("f: g. g: f. : f.")) == "(Expression (FunctionCall f(ExpressionInput )))");
+		expect(PrintBody(Inline("[/type/i32] f: + 1. : 5 f.")) == "(Expression (FunctionCall f(Literal 5)))");
+		expect(PrintBody(Inline("f: + 1 + 2 + 3. : 5 f.", 4)) == "(Expression (FunctionCall f(Literal 5)))");
+		expect(PrintBody(Inline("f (a): + a. : 5 f (1 + 2).")).starts_with("(Expression (FunctionCall f"));
+		expect(PrintBody(Inline("inc: + 1. : 5 inc.", 0)) == "(Expression (FunctionCall inc(Literal 5)))");
+	};
+
+	"hot functions"_test = [] {
+		// Hot functions are inlined with up to four times the size.
+		auto profile = std::make_shared<Profile>();
+		std::istringstream report("1\t0\t0\tmain\n1000\t0\t0\tf\n1\t0\t0\tg\n");
+		profile->Read(report);
+
+		expect(PrintBody(Inline("f: + 1 + 2 + 3. : 5 f.", 4, profile)).starts_with("(Expression (BinaryOperation +(Literal 5)"));
+		expect(PrintBody(Inline("g: + 1 + 2 + 3. : 5 g.", 4, profile)) == "(Expression (FunctionCall g(Literal 5)))");
+	};
+
+	"generated code"_test = [] {
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		"double: * 2. inc: + 1. : 5 double inc." >> lexer >> tokens >> parser >> nodes;
+
+		Analyzer analyzer;
+		analyzer.options.inlineSize = 16;
+		analyzer.options.removeUnreachable = true;
+		analyzer.Analyze(nodes);
+		expect(analyzer.GetErrors().empty());
+
+		VectorCoderCpp coder;
+		std::ostringstream output;
+		nodes >> coder >> output;
+
+		// The calls are inlined and folded, and the functions removed.
+		expect(output.str().find("f_") == std::string::npos) << output.str();
+		expect(output.str().find("= 11;") != std::string::npos) << output.str();
+	};
+};
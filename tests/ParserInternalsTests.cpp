@@ -1,4 +1,5 @@
 #include "pch.h"
+#include <random>
 
 class ParserTest
 {
@@ -14,6 +15,48 @@ public:
 	{
 		return Parser::GetPrimitiveIntegerTypeSpec(value);
 	}
+
+	[[nodiscard]] static TypeSpec GetPrimitiveDecimalTypeSpec(std::string_view value)
+	{
+		return Parser::GetPrimitiveDecimalTypeSpec(value);
+	}
+
+	// The former regex based implementation of GetPrimitiveDecimalTypeSpec, kept as reference.
+	[[nodiscard]] static TypeSpec GetPrimitiveDecimalTypeSpecReference(const std::string& value)
+	{
+		static const std::regex literalRegex{ R"([+\-]?(\d+)\.(\d+)([eE][+\-]?\d+)?)" };
+		std::smatch literalMatch;
+		if (!std::regex_match(value, literalMatch, literalRegex))
+			return TypeSpec::Invalid();
+
+		const auto digits = literalMatch[1].str() + literalMatch[2].str();
+
+		static const std::regex trimmedRegex{ R"(0*(\d+?)0*)" };
+		std::smatch trimmedMatch;
+		if (!std::regex_match(digits, trimmedMatch, trimmedRegex))
+			return TypeSpec::Invalid();
+
+		const auto trimmedDigits = trimmedMatch[1].str();
+		const auto mantissa = to_int<uint64_t>(trimmedDigits).unsignedValue.value_or(std::numeric_limits<uint64_t>::max());
+		const bool requireDouble = mantissa >= 8388608;
+
+		if (!requireDouble)
+		{
+			float f{};
+			auto [ptrFloat, errorFloat] = std::from_chars(value.data(), value.data() + value.size(), f);
+
+			if (errorFloat == std::errc{})
+				return { .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .floatType = true} };
+		}
+
+		double d{};
+		auto [ptrDouble, errorDouble] = std::from_chars(value.data(), value.data() + value.size(), d);
+
+		if (errorDouble == std::errc{})
+			return { .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 64, .floatType = true} };
+
+		return TypeSpec::Invalid();
+	}
 };
 
 using namespace boost::ut;
@@ -86,3 +129,88 @@ suite parser_GetPrimitiveTypeSpec_tests = [] {
 	static_assert(ParserTest::GetPrimitiveIntegerTypeSpec("-9223372036854775809") == TypeSpec{ .kind = TypeSpec::Kind::Invalid });
 	static_assert(ParserTest::GetPrimitiveIntegerTypeSpec("18446744073709551616") == TypeSpec{ .kind = TypeSpec::Kind::Invalid });
 };
+
+suite parser_GetPrimitiveDecimalTypeSpec_tests = [] {
+	static constexpr TypeSpec f32{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .floatType = true} };
+	static constexpr TypeSpec f64{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 64, .floatType = true} };
+
+	"f32"_test = [] {
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("0.0") == f32);
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("-1.5") == f32);
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("8388607.0") == f32);
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("000123.4560000") == f32);
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("1.0e30") == f32);
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("3.4e38") == f32);
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("1.0e-45") == f32);
+	};
+
+	"f64"_test = [] {
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("8388608.0") == f64);
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("3.14159265") == f64);
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("1.0e300") == f64);
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("3.5e38") == f64);
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("1.0e-300") == f64);
+	};
+
+	"invalid"_test = [] {
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("") == TypeSpec::Invalid());
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("1") == TypeSpec::Invalid());
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("1.") == TypeSpec::Invalid());
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec(".1") == TypeSpec::Invalid());
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("1.0e") == TypeSpec::Invalid());
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("1.0e+") == TypeSpec::Invalid());
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("1.0x") == TypeSpec::Invalid());
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("+1.0") == TypeSpec::Invalid());
+		expect(ParserTest::GetPrimitiveDecimalTypeSpec("1.0e400") == TypeSpec::Invalid());
+	};
+
+	"differential"_test = [] {
+		std::mt19937 random{ 12345 };
+		const auto roll = [&](int max) { return std::uniform_int_distribution<int>{0, max}(random); };
+
+		const auto digits = [&](int count, bool zeros)
+		{
+			std::string s;
+			for (int i = 0; i < count; ++i)
+				s += static_cast<char>('0' + (zeros && roll(2) ? 0 : roll(9)));
+			return s;
+		};
+
+		size_t mismatches = 0;
+
+		for (int i = 0; i < 20000; ++i)
+		{
+			std::string value;
+
+			if (!roll(9))
+				value += roll(3) ? '-' : '+';
+
+			const bool zeros = !roll(3);
+			value += digits(1 + roll(roll(1) ? 3 : 22), zeros);
+			value += '.';
+			value += digits(1 + roll(roll(1) ? 3 : 22), zeros);
+
+			if (roll(3))
+			{
+				value += roll(1) ? 'e' : 'E';
+
+				switch (roll(2))
+				{
+				case 0: value += '-'; break;
+				case 1: value += '+'; break;
+				}
+
+				static constexpr std::array<int, 4> exponentRanges{ 9, 60, 400, 100000 };
+				value += std::to_string(roll(exponentRanges[roll(3)]));
+			}
+
+			const auto expected = ParserTest::GetPrimitiveDecimalTypeSpecReference(value);
+			const auto actual = ParserTest::GetPrimitiveDecimalTypeSpec(value);
+
+			if (actual != expected && ++mismatches <= 10)
+				std::cerr << "Decimal literal \"" << value << "\": " << actual << ", expected " << expected << '\n';
+		}
+
+		expect(mismatches == 0_u);
+	};
+};
@@ -9,16 +9,17 @@ public:
 		return YieldsNodes(name, code, std::initializer_list<std::reference_wrapper<const Node>> { expectedTree });
 	}
 
-	bool YieldsNodes(std::string_view name, std::string_view code, const std::ranges::range auto& expectedRange);
+	bool YieldsNodes(std::string_view name, std::string_view code, const std::ranges::range auto& expectedRange, const Parser::Options& options = {});
 };
 
 static ParserTest parserTest;
 
-bool ParserTest::YieldsNodes(std::string_view name, std::string_view code, const std::ranges::range auto& expectedRange)
+bool ParserTest::YieldsNodes(std::string_view name, std::string_view code, const std::ranges::range auto& expectedRange, const Parser::Options& options)
 {
 	StringLexer lexer;
 	std::vector<Token> tokens;
 	VectorParser parser;
+	parser.options = options;
 	std::vector<Node> nodes;
 	code >> lexer >> tokens >> parser >> nodes;
 
@@ -73,9 +74,8 @@ suite parser_lexer_error_tests = [] {
 	"invalid identifier"_test = [] {
 		expect(parserTest.YieldsNodes("invalid identifier",
 			"1abc",
-			std::array<Node, 3>
+			std::array<Node, 2>
 			{
-				Node{ .type = Node::Type::Error, .error{.code = Node::Error::Code::ParseError } },
 				Node{ .type = Node::Type::Error, .error{.code = Node::Error::Code::ParseError } },
 				Node{ .type = Node::Type::FunctionDeclaration, .value = "abc" },
 			}
@@ -83,6 +83,63 @@ suite parser_lexer_error_tests = [] {
 	};
 };
 
+suite parser_error_recovery_tests = [] {
+	"skip to full stop"_test = [] {
+		expect(parserTest.YieldsNodes("skip to full stop",
+			"func: 1 2 3 (4 5. 6) 7. next",
+			std::array<Node, 2>
+			{
+				Node{ .type = Node::Type::Error, .error{.code = Node::Error::Code::ParseError } },
+				Node{ .type = Node::Type::FunctionDeclaration, .value = "next" },
+			}
+		));
+	};
+	"skip body with calls"_test = [] {
+		expect(parserTest.YieldsNodes("skip body with calls",
+			"func: g ] h (i j. k) l. next",
+			std::array<Node, 2>
+			{
+				Node{ .type = Node::Type::Error, .error{.code = Node::Error::Code::ParseError } },
+				Node{ .type = Node::Type::FunctionDeclaration, .value = "next" },
+			}
+		));
+	};
+	"skip to declaration"_test = [] {
+		expect(parserTest.YieldsNodes("skip to declaration",
+			"1 2 3 'a' 4 -> next",
+			std::array<Node, 2>
+			{
+				Node{ .type = Node::Type::Error, .error{.code = Node::Error::Code::ParseError } },
+				Node{ .type = Node::Type::FunctionDeclaration, .value = "next", .apiSpec{.flags = ApiSpec::Import} },
+			}
+		));
+	};
+	"coalesced errors"_test = [] {
+		expect(parserTest.YieldsNodes("coalesced errors",
+			"[[ [[ [[ [[ [[ next",
+			std::array<Node, 4>
+			{
+				Node{ .type = Node::Type::Error, .error{.code = Node::Error::Code::ParseError } },
+				Node{ .type = Node::Type::Error, .error{.code = Node::Error::Code::ParseError } },
+				Node{ .type = Node::Type::Error, .error{.code = Node::Error::Code::ParseError } },
+				Node{ .type = Node::Type::FunctionDeclaration, .value = "next" },
+			},
+			{ .maxErrorsPerDeclaration = 2 }
+		));
+	};
+	"coalesced errors at end"_test = [] {
+		expect(parserTest.YieldsNodes("coalesced errors at end",
+			"[[ [[ [[ [[",
+			std::array<Node, 2>
+			{
+				Node{ .type = Node::Type::Error, .error{.code = Node::Error::Code::ParseError } },
+				Node{ .type = Node::Type::Error, .error{.code = Node::Error::Code::ParseError } },
+			},
+			{ .maxErrorsPerDeclaration = 1 }
+		));
+	};
+};
+
 suite parser_function_declaration_input_types_tests = [] {
 	"trivial function declaration"_test = [] {
 		expect(parserTest.YieldsNodes("trivial function declaration",
@@ -0,0 +1,57 @@
+#include "pch.h"
+#include "../lovela/Profile.h"
+
+using namespace boost::ut;
+
+namespace
+{
+	std::vector<Node> Parse(std::string_view code)
+	{
+		StringLexer lexer;
+		std::vector<Token> tokens;
+		VectorParser parser;
+		std::vector<Node> nodes;
+		code >> lexer >> tokens >> parser >> nodes;
+		return nodes;
+	}
+}
+
+suite profile_tests = [] {
+	"read"_test = [] {
+		const auto nodes = Parse("f: 1. ns/g: 2. h: 3. : f.");
+
+		// The header and malformed lines are ignored, and the calls of a function on several lines are added.
+		Profile profile;
+		std::istringstream report("Calls\tInclusive ms\tExclusive ms\tFunction\r\n"
+			"1\t0.5\t0.1\tmain\r\n"
+			"100\t0.4\t0.4\tf\r\n"
+			"x\t1\t1\th\n"
+			"7\t1\th\n"
+			"50\t0.1\t0.1\tns/g\n"
+			"50\t0.1\t0.1\tns/g\n");
+		profile.Read(report);
+
+		expect(!profile.IsEmpty());
+		expect(profile.GetCalls(nodes[0]) == 100_ull);
+		expect(profile.GetCalls(nodes[1]) == 100_ull);
+		expect(profile.GetCalls(nodes[2]) == 0_ull);
+		expect(profile.GetCalls(nodes[3]) == 1_ull);
+	};
+
+	"heat"_test = [] {
+		const auto nodes = Parse("f: 1. g: 2. h: 3. i: 4. : f.");
+
+		Profile profile;
+		expect(profile.GetHeat(nodes[0]) == Profile::Heat::Unknown);
+
+		// The hot functions have 90% of the calls.
+		std::istringstream report("1\t0\t0\tmain\n500\t0\t0\tf\n450\t0\t0\tg\n49\t0\t0\th\n");
+		profile.Read(report);
+
+		expect(profile.GetHeat(nodes[0]) == Profile::Heat::Hot);
+		expect(profile.GetHeat(nodes[1]) == Profile::Heat::Hot);
+		expect(profile.GetHeat(nodes[2]) == Profile::Heat::Normal);
+		expect(profile.GetHeat(nodes[3]) == Profile::Heat::Cold);
+		expect(profile.GetHeat(nodes[4]) == Profile::Heat::Normal);
+	};
+};
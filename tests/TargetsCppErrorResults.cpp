@@ -0,0 +1,271 @@
+#include "pch.h"
+#include "../targets/cpp/lovela-runtime/lovela.h"
+#include "../targets/cpp/lovela-runtime/lovela-result.h"
+
+// The error handling of TargetsCppErrorHandling.cpp with results instead of exceptions.
+// A function that may fail returns a lovela::result, its callers return the error on with a branch,
+// and an error handler is a branch on the result instead of a try and catch.
+
+lovela::result<int> f_RaisesResultError(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	static const lovela::error_code e1{ "error" };
+	auto& v1 = in; static_cast<void>(v1);
+	if (v1) { return lovela::fail(e1); }
+	return v1;
+}
+
+auto f_ResultErrorHandlerReset(lovela::context& context, const auto& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	return v1;
+}
+
+lovela::result<int> fb_WithTailResultErrorHandlerOnError(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = 200;
+	auto v3 = f_RaisesResultError(context, v2);
+	return v3;
+}
+
+int f_WithTailResultErrorHandlerOnError(lovela::context& context, int in)
+{
+	auto& i1 = in; static_cast<void>(i1);
+
+	auto o1 = fb_WithTailResultErrorHandlerOnError(context, i1);
+
+	if (!o1)
+	{
+		context.error = lovela::error(o1.error().message(), o1.error().code());
+		o1 = f_ResultErrorHandlerReset(context, i1);
+	}
+
+	return *o1;
+}
+
+lovela::result<int> fb_WithTailResultErrorHandlerOnSuccess(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = 200;
+	return v2;
+}
+
+int f_WithTailResultErrorHandlerOnSuccess(lovela::context& context, int in)
+{
+	auto& i1 = in; static_cast<void>(i1);
+
+	auto o1 = fb_WithTailResultErrorHandlerOnSuccess(context, i1);
+
+	if (!o1)
+	{
+		context.error = lovela::error(o1.error().message(), o1.error().code());
+		o1 = f_ResultErrorHandlerReset(context, i1);
+	}
+
+	return *o1;
+}
+
+lovela::result<int> fb1_WithMidResultErrorHandlerOnError(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = v1 + 10;
+	auto v3 = f_RaisesResultError(context, v2);
+	if (!v3) { return lovela::fail(v3.error()); }
+	auto v4 = *v3 + 1;
+	return v4;
+}
+
+lovela::result<double> fb2_WithMidResultErrorHandlerOnError(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = v1 + 1.23;
+	return v2;
+}
+
+double f_WithMidResultErrorHandlerOnError(lovela::context& context, int in)
+{
+	auto& i1 = in; static_cast<void>(i1);
+
+	auto o1 = fb1_WithMidResultErrorHandlerOnError(context, i1);
+
+	if (!o1)
+	{
+		context.error = lovela::error(o1.error().message(), o1.error().code());
+		o1 = f_ResultErrorHandlerReset(context, i1);
+	}
+
+	auto& i2 = *o1;
+
+	auto o2 = fb2_WithMidResultErrorHandlerOnError(context, i2);
+
+	if (!o2)
+	{
+		context.error = lovela::error(o2.error().message(), o2.error().code());
+		o2 = f_ResultErrorHandlerReset(context, i2);
+	}
+
+	return *o2;
+}
+
+// A workload where every other call fails two calls below its error handler, in both modes.
+
+int f_HalveThrowing(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	if (v1 % 2) { throw lovela::error("odd"); }
+	return v1 / 2;
+}
+
+int fb_HalveTwiceThrowing(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_HalveThrowing(context, v1);
+	auto v3 = f_HalveThrowing(context, v2 * 2);
+	return v3 + 1;
+}
+
+int f_HalveTwiceThrowing(lovela::context& context, int in)
+{
+	auto& i1 = in; static_cast<void>(i1);
+
+	int o1;
+
+	try
+	{
+		o1 = fb_HalveTwiceThrowing(context, i1);
+	}
+	catch (const lovela::error& error)
+	{
+		context.error = error;
+		o1 = 0;
+	}
+
+	return o1;
+}
+
+lovela::result<int> f_HalveResult(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	static const lovela::error_code e1{ "odd" };
+	auto& v1 = in; static_cast<void>(v1);
+	if (v1 % 2) { return lovela::fail(e1); }
+	return v1 / 2;
+}
+
+lovela::result<int> fb_HalveTwiceResult(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_HalveResult(context, v1);
+	if (!v2) { return lovela::fail(v2.error()); }
+	auto v3 = f_HalveResult(context, *v2 * 2);
+	if (!v3) { return lovela::fail(v3.error()); }
+	return *v3 + 1;
+}
+
+int f_HalveTwiceResult(lovela::context& context, int in)
+{
+	auto& i1 = in; static_cast<void>(i1);
+
+	auto o1 = fb_HalveTwiceResult(context, i1);
+
+	if (!o1)
+	{
+		context.error = lovela::error(o1.error().message(), o1.error().code());
+		o1 = 0;
+	}
+
+	return *o1;
+}
+
+using namespace boost::ut;
+
+suite ErrorResults = [] {
+	"RaisesResultError"_test = [] {
+		lovela::context context;
+		const auto result = f_RaisesResultError(context, 100);
+		expect(!result.has_value());
+		expect(result.error() == lovela::error_code("error"));
+		expect(result.error().code() != 0_i);
+		expect(std::string_view(result.error().message()) == "error");
+		expect(f_RaisesResultError(context, 0).value() == 0_i);
+	};
+
+	"ErrorCodes"_test = [] {
+		// The codes are interned by the message.
+		const lovela::error_code first{ "first" };
+		const lovela::error_code second{ "second" };
+		expect(first == lovela::error_code("first"));
+		expect(first != second);
+		expect(!lovela::error_code());
+		expect(bool(first));
+
+		// The messages are copied, so they can come from a string that doesn't outlive the error.
+		const lovela::error_code copied{ std::string("first") };
+		expect(copied == first);
+		expect(std::string_view(copied.message()) == "first");
+	};
+
+	"AttemptThrowingFunction"_test = [] {
+		// The errors that the functions that the program doesn't define throw are converted to results.
+		const auto failed = lovela::attempt([] { throw lovela::error(std::string("thrown").c_str()); return 1; });
+		expect(!failed.has_value());
+		expect(failed.error() == lovela::error_code("thrown"));
+		expect(lovela::attempt([] { return 2; }).value() == 2_i);
+		expect(lovela::attempt([] {}).has_value());
+	};
+
+	"WithTailResultErrorHandlerOnError"_test = [] {
+		lovela::context context;
+		expect(f_WithTailResultErrorHandlerOnError(context, 100) == 100);
+		expect(context.error.message == "error");
+		expect(context.error.code == lovela::error_code("error").code());
+	};
+
+	"WithTailResultErrorHandlerOnSuccess"_test = [] {
+		lovela::context context;
+		expect(f_WithTailResultErrorHandlerOnSuccess(context, 100) == 200);
+		expect(context.error.code == 0_i);
+	};
+
+	"WithMidResultErrorHandlerOnError"_test = [] {
+		lovela::context context;
+		expect(f_WithMidResultErrorHandlerOnError(context, 100) == 101.23);
+	};
+};
+
+suite ErrorResultsBenchmark = [] {
+	// A benchmark, which is skipped unless the tests are run with the benchmark tag as argument.
+	tag("benchmark") / "error-heavy workload"_test = [] {
+		constexpr int calls = 100'000;
+
+		const auto run = [](auto function)
+		{
+			lovela::context context;
+			int64_t sum = 0;
+
+			const auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < calls; ++i)
+				sum += function(context, i);
+			const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+			return std::pair{ sum, seconds.count() };
+		};
+
+		const auto exceptions = run(f_HalveTwiceThrowing);
+		const auto results = run(f_HalveTwiceResult);
+
+		std::cerr << fmt::format("Handled {} errors in {} calls with exceptions in {:.3f} s, and with results in {:.3f} s.\n",
+			calls / 2, calls, exceptions.second, results.second);
+
+		expect(results.first == exceptions.first);
+	};
+};
@@ -16,6 +16,62 @@ auto f_ReturnInputIncremented(lovela::context& context, const auto& in)
 	return v2;
 }
 
+// [/type/i32] double [/type/i32]: * 2.
+constexpr int f_double(int in)
+{
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = v1 * 2; static_cast<void>(v2);
+	return v2;
+}
+
+// [/type/i32] quadruple [/type/i32]: double double.
+constexpr int f_quadruple(int in)
+{
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_double(f_double(std::forward<decltype(in)>(v1))); static_cast<void>(v2);
+	return v2;
+}
+
+// triple: * 3.
+constexpr auto f_triple(auto&& in)
+{
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = v1 * 3; static_cast<void>(v2);
+	return v2;
+}
+
+// Constant functions are evaluated at compile time.
+static_assert(f_quadruple(3) == 12);
+static_assert(f_triple(1.5) == 4.5);
+
+// An imported function that ends the recursion of f_countdown with an error, and records the stack depth of its calls.
+struct CountdownCheck
+{
+	size_t calls{};
+	std::set<const void*> stackAddresses;
+} s_countdownCheck;
+
+int f_check(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	const int local{};
+	++s_countdownCheck.calls;
+	s_countdownCheck.stackAddresses.insert(&local);
+	if (!in) { throw lovela::error("done"); }
+	return in;
+}
+
+// [/type/i32] countdown [/type/i32]: check - 1 countdown.
+int f_countdown(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	for (;;)
+	{
+		auto& v1 = in; static_cast<void>(v1);
+		in = int((f_check(context, std::forward<decltype(in)>(v1)) - 1));
+	}
+}
+
 using namespace boost::ut;
 
 suite FunctionCalls = [] {
@@ -28,4 +84,12 @@ suite FunctionCalls = [] {
 		lovela::context context;
 		expect(f_ReturnInputIncremented(context, 100) == 101);
 	};
+
+	"SelfTailCall"_test = [] {
+		// The recursion is a loop, so it runs in constant stack at any depth.
+		lovela::context context;
+		expect(throws<lovela::error>([&] { static_cast<void>(f_countdown(context, 10'000'000)); }));
+		expect(s_countdownCheck.calls == 10'000'001_ul);
+		expect(s_countdownCheck.stackAddresses.size() == 1_ul);
+	};
 };
@@ -0,0 +1,169 @@
+#include "pch.h"
+#include "../targets/cpp/lovela-runtime/lovela.h"
+
+// The code generated for:
+// Move1: . Move2: Move1. ... Move10: Move9.
+// MoveChain: Move1 Move2 Move3 Move4 Move5 Move6 Move7 Move8 Move9 Move10.
+
+auto&& f_Move1(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	return std::forward<decltype(in)>(v1);
+}
+
+auto f_Move2(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_Move1(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	return v2;
+}
+
+auto f_Move3(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_Move2(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	return v2;
+}
+
+auto f_Move4(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_Move3(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	return v2;
+}
+
+auto f_Move5(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_Move4(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	return v2;
+}
+
+auto f_Move6(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_Move5(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	return v2;
+}
+
+auto f_Move7(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_Move6(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	return v2;
+}
+
+auto f_Move8(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_Move7(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	return v2;
+}
+
+auto f_Move9(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_Move8(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	return v2;
+}
+
+auto f_Move10(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_Move9(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	return v2;
+}
+
+auto f_MoveChain(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_Move10(context, f_Move9(context, f_Move8(context, f_Move7(context, f_Move6(context, f_Move5(context, f_Move4(context, f_Move3(context, f_Move2(context, f_Move1(context, std::forward<decltype(in)>(v1))))))))))); static_cast<void>(v2);
+	return v2;
+}
+
+// The same chain, generated with CoderCpp::Options::namedLocals.
+
+auto f_MoveChainNamed(lovela::context& context, auto&& in)
+{
+	static_cast<void>(context);
+	auto& v1 = in; static_cast<void>(v1);
+	auto v2 = f_Move1(context, std::forward<decltype(in)>(v1)); static_cast<void>(v2);
+	auto v3 = f_Move2(context, std::move(v2)); static_cast<void>(v3);
+	auto v4 = f_Move3(context, std::move(v3)); static_cast<void>(v4);
+	auto v5 = f_Move4(context, std::move(v4)); static_cast<void>(v5);
+	auto v6 = f_Move5(context, std::move(v5)); static_cast<void>(v6);
+	auto v7 = f_Move6(context, std::move(v6)); static_cast<void>(v7);
+	auto v8 = f_Move7(context, std::move(v7)); static_cast<void>(v8);
+	auto v9 = f_Move8(context, std::move(v8)); static_cast<void>(v9);
+	auto v10 = f_Move9(context, std::move(v9)); static_cast<void>(v10);
+	auto v11 = f_Move10(context, std::move(v10)); static_cast<void>(v11);
+	return v11;
+}
+
+namespace
+{
+	// Counts the copies of an array, to check that the generated code moves values through function calls.
+	struct CountedArray
+	{
+		static inline size_t copies{};
+
+		lovela::dynamic_array<int> items;
+
+		CountedArray() = default;
+		CountedArray(const CountedArray& src) : items(src.items) { ++copies; }
+		CountedArray(CountedArray&& src) noexcept = default;
+		CountedArray& operator=(const CountedArray& src) { items = src.items; ++copies; return *this; }
+		CountedArray& operator=(CountedArray&& src) noexcept = default;
+	};
+}
+
+using namespace boost::ut;
+
+suite MoveSemantics = [] {
+	"moved value isn't copied"_test = [] {
+		lovela::context context;
+		CountedArray array;
+		array.items.set_size(1000);
+		array.items.set_item(1000, 123);
+
+		CountedArray::copies = 0;
+		auto result = f_MoveChain(context, std::move(array));
+		expect(CountedArray::copies == 0_u);
+		expect(result.items.get_size() == 1000_u);
+		expect(result.items.get_item(1000) == 123_i);
+	};
+
+	"moved value isn't copied with named locals"_test = [] {
+		lovela::context context;
+		CountedArray array;
+		array.items.set_size(1000);
+
+		CountedArray::copies = 0;
+		auto result = f_MoveChainNamed(context, std::move(array));
+		expect(CountedArray::copies == 0_u);
+		expect(result.items.get_size() == 1000_u);
+	};
+
+	"referenced value is copied once"_test = [] {
+		lovela::context context;
+		CountedArray array;
+		array.items.set_size(1000);
+
+		CountedArray::copies = 0;
+		auto result = f_MoveChain(context, array);
+		expect(CountedArray::copies == 1_u);
+		expect(array.items.get_size() == 1000_u);
+		expect(result.items.get_size() == 1000_u);
+	};
+};
@@ -0,0 +1,59 @@
+#include "pch.h"
+#include "../targets/cpp/lovela-runtime/lovela.h"
+
+auto f_ProfiledCallee(lovela::context& context, const auto& in)
+{
+	static_cast<void>(context);
+	static const lovela::profiler::function profiler_function{ "ProfiledCallee" };
+	const lovela::profiler::scope profiler_scope{ profiler_function };
+	auto& v1 = in; static_cast<void>(v1);
+	return v1;
+}
+
+int f_ProfiledRecursive(lovela::context& context, int in)
+{
+	static_cast<void>(context);
+	static const lovela::profiler::function profiler_function{ "ProfiledRecursive" };
+	const lovela::profiler::scope profiler_scope{ profiler_function };
+	auto& v1 = in; static_cast<void>(v1);
+	return v1 ? f_ProfiledRecursive(context, v1 - 1) + f_ProfiledCallee(context, 1) : 0;
+}
+
+using namespace boost::ut;
+
+suite Profiler = [] {
+	"calls"_test = [] {
+		lovela::context context;
+		expect(f_ProfiledRecursive(context, 3) == 3);
+		expect(f_ProfiledCallee(context, 1.5) == 1.5);
+
+		std::ostringstream report;
+		lovela::profiler::report(report, false);
+
+		// Both instantiations of the callee are counted together.
+		expect(report.str().starts_with("Calls\tInclusive ms\tExclusive ms\tFunction\n")) << report.str();
+		expect(report.str().find("\n4\t") != std::string::npos && report.str().find("\tProfiledRecursive\n") != std::string::npos) << report.str();
+		expect(report.str().find("\n4\t") != std::string::npos && report.str().find("\tProfiledCallee\n") != std::string::npos) << report.str();
+	};
+
+	"json"_test = [] {
+		std::ostringstream report;
+		lovela::profiler::report(report, true);
+
+		expect(report.str().starts_with("[\n  { \"function\": \"")) << report.str();
+		expect(report.str().find("\"function\": \"ProfiledRecursive\", \"calls\": 4, \"inclusive_ms\": ") != std::string::npos) << report.str();
+		expect(report.str().ends_with(" }\n]\n")) << report.str();
+	};
+
+	"threads"_test = [] {
+		std::thread([] {
+			lovela::context context;
+			f_ProfiledCallee(context, 1);
+		}).join();
+
+		std::ostringstream report;
+		lovela::profiler::report(report, true);
+
+		expect(report.str().find("\"function\": \"ProfiledCallee\", \"calls\": 5,") != std::string::npos) << report.str();
+	};
+};
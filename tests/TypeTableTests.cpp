@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "../lovela/TypeTable.h"
+#include "../lovela/ThreadPool.h"
+
+using namespace boost::ut;
+
+suite type_table_tests = [] {
+	"equal types share the id"_test = [] {
+		const TypeSpec i32{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32, .signedType = true} };
+		const TypeSpec u32{ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 32} };
+
+		const auto a = TypeTable::Intern(i32);
+		const auto b = TypeTable::Intern(i32);
+		const auto c = TypeTable::Intern(u32);
+
+		expect(a.id != 0_u);
+		expect(a.id == b.id);
+		expect(a.id != c.id);
+		expect(TypeTable::Intern(a).id == a.id);
+	};
+
+	"interned and uninterned types compare by value"_test = [] {
+		const TypeSpec named{ .kind = TypeSpec::Kind::Named, .name = "thing", .arrayDims{0, 3} };
+		const auto interned = TypeTable::Intern(named);
+
+		expect(interned == named);
+		expect(named == interned);
+		expect(interned != TypeTable::Intern({ .kind = TypeSpec::Kind::Named, .name = "thing", .arrayDims{0, 4} }));
+		expect(std::hash<TypeSpec>{}(interned) == std::hash<TypeSpec>{}(named));
+	};
+
+	"cached names"_test = [] {
+		const auto type = TypeTable::Intern({ .kind = TypeSpec::Kind::Primitive, .nameSpace{.parts{"type"}, .root = true}, .arrayDims{0}, .primitive{.bits = 8, .signedType = true} });
+		const auto& entry = TypeTable::GetEntry(type.id);
+
+		expect(entry.type == type);
+		expect(entry.qualifiedName == "[/type/i8]#");
+		expect(type.GetQualifiedName() == entry.qualifiedName);
+		expect(entry.hash == TypeTable::Hash(type));
+	};
+
+	"mutators reset the id"_test = [] {
+		auto type = TypeTable::Intern({ .kind = TypeSpec::Kind::Named, .name = "before" });
+		type.SetName("after");
+		expect(type.id == 0_u);
+		expect(type == TypeSpec{ .kind = TypeSpec::Kind::Named, .name = "after" });
+
+		type = TypeTable::Intern({ .kind = TypeSpec::Kind::Primitive, .primitive{.bits = 16, .signedType = true} });
+		type.SetPrimitive({ .bits = 16 });
+		expect(type.id == 0_u);
+		expect(type.GetQualifiedName() == "[u16]");
+	};
+
+	"concurrent interning"_test = [] {
+		ThreadPool pool(4);
+		std::vector<TypeId> ids(1000);
+		pool.ForEach(ids.size(), [&](size_t index)
+			{
+				ids[index] = TypeTable::Intern({ .kind = TypeSpec::Kind::Named, .name = fmt::format("concurrent{}", index % 10) }).id;
+			});
+
+		bool shared = true;
+		for (size_t i = 10; i < ids.size(); ++i)
+			shared = shared && ids[i] == ids[i % 10];
+		expect(shared);
+	};
+
+	"entries are read while types are added"_test = [] {
+		// Enough types for several segments of the table.
+		ThreadPool pool(4);
+		std::vector<char> found(1000);
+		pool.ForEach(found.size(), [&](size_t index)
+			{
+				const auto type = TypeTable::Intern({ .kind = TypeSpec::Kind::Named, .name = fmt::format("segmented{}", index) });
+				found[index] = TypeTable::GetEntry(type.id).type.name == type.name;
+			});
+
+		expect(std::ranges::count(found, 0) == 0_l);
+	};
+};